@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "difference.hpp"
+#include "kmer.hpp"
+#include "packed_compare.hpp"
+
+namespace dna
+{
+
+namespace detail
+{
+
+// bases of each side aligned around a mismatch cluster
+constexpr std::size_t align_window_bases = 512;
+
+// rows of the bit-parallel alignment handled per machine word
+constexpr std::size_t align_block_bases = 64;
+
+// a mismatch starts a cluster if this many of the next 64 bases differ
+constexpr std::size_t cluster_min_mismatches = 12;
+
+// seeds used to find the diagonal again at the start of a shard, or after
+// an indel too long for align_window()
+constexpr std::size_t resync_kmer_bases = 20;
+constexpr std::size_t resync_window_bases = 1024;
+constexpr std::size_t resync_slack_bases = 4096;
+// seeds of b looked up, one in this many
+constexpr std::size_t resync_stride = 4;
+
+// longest stretch left unaligned after clusters nothing explains
+constexpr std::size_t max_plain_bases = std::size_t{1} << 16;
+
+/*
+ * Number of positions k in [0, length) where a[ia + k] != b[ib + k].
+ */
+template<class A, class B>
+std::size_t count_mismatches(const A& a, std::size_t ia, const B& b, std::size_t ib, std::size_t length)
+{
+	std::size_t count = 0;
+	for (std::size_t k = 0; k < length; k += word_bases)
+	{
+		auto bits = differing_bases((a.word_at(ia + k) ^ b.word_at(ib + k)) & word_mask(length - k));
+		count += static_cast<std::size_t>(__builtin_popcountll(bits));
+	}
+	return count;
+}
+
+/*
+ * Whether the 64 bases at a[ia] and b[ib] differ enough to be out of step
+ * rather than a few SNPs. Fewer bases need proportionally fewer mismatches.
+ */
+template<class A, class B>
+bool mismatch_cluster(const A& a, std::size_t ia, const B& b, std::size_t ib, std::size_t length)
+{
+	constexpr std::size_t cluster_bases = 2 * word_bases;
+	length = std::min(length, cluster_bases);
+	return count_mismatches(a, ia, b, ib, length) * cluster_bases >= cluster_min_mismatches * length;
+}
+
+/*
+ * A packed word with its 32 bases in reverse order, so base t of the word
+ * sits at bits 2t and 2t + 1.
+ */
+constexpr packed_word reverse_bases(packed_word word)
+{
+	word = __builtin_bswap64(word);
+	word = ((word >> 2) & 0x3333333333333333ull) | ((word & 0x3333333333333333ull) << 2);
+	return ((word >> 4) & 0x0f0f0f0f0f0f0f0full) | ((word & 0x0f0f0f0f0f0f0f0full) << 4);
+}
+
+/*
+ * Gathers bits 0, 2, 4, ... of `bits` into bits 0, 1, 2, ...
+ */
+constexpr std::uint64_t even_bits(std::uint64_t bits)
+{
+	bits &= 0x5555555555555555ull;
+	bits = (bits | (bits >> 1)) & 0x3333333333333333ull;
+	bits = (bits | (bits >> 2)) & 0x0f0f0f0f0f0f0f0full;
+	bits = (bits | (bits >> 4)) & 0x00ff00ff00ff00ffull;
+	bits = (bits | (bits >> 8)) & 0x0000ffff0000ffffull;
+	return (bits | (bits >> 16)) & 0x00000000ffffffffull;
+}
+
+/*
+ * Bit t set where seq[index + t] is `b`, for t in [0, 64), from two packed
+ * words. Bases past the end read as A.
+ */
+template<class S>
+std::uint64_t match_mask(const S& seq, std::size_t index, base b)
+{
+	auto broadcast = static_cast<packed_word>(b) * 0x5555555555555555ull;
+	std::uint64_t mask = 0;
+	for (std::size_t half = 0; half < 2; ++half)
+	{
+		auto same = ~(reverse_bases(seq.word_at(index + half * word_bases)) ^ broadcast);
+		mask |= even_bits(same & (same >> 1)) << (half * word_bases);
+	}
+	return mask;
+}
+
+/*
+ * One column of one 64 row block of Myers' bit-parallel edit distance, in
+ * Hyyrö's block form. Takes the vertical deltas of the previous column
+ * (bit r of pv/mv set where the cost rises/falls from row r to r + 1), the
+ * rows matching this column's base and the horizontal delta entering at the
+ * top (-1, 0 or +1). Stores this column's deltas and returns the horizontal
+ * delta leaving at the bottom.
+ */
+inline int myers_block(std::uint64_t pv, std::uint64_t mv, std::uint64_t eq, int carry,
+		std::uint64_t& pv_out, std::uint64_t& mv_out)
+{
+	std::uint64_t falls = carry < 0 ? 1 : 0;
+	std::uint64_t rises = carry > 0 ? 1 : 0;
+	auto xv = eq | mv;
+	eq |= falls;
+	auto xh = (((eq & pv) + pv) ^ pv) | eq;
+	auto ph = mv | ~(xh | pv);
+	auto mh = pv & xh;
+	auto out = static_cast<int>(ph >> 63) - static_cast<int>(mh >> 63);
+	ph = (ph << 1) | rises;
+	mh = (mh << 1) | falls;
+	pv_out = mh | ~(xv | ph);
+	mv_out = ph & xv;
+	return out;
+}
+
+}
+
+enum class edit_op : std::uint8_t
+{
+	match,
+	substitute,
+	// a base of b that a doesn't have
+	insert,
+	// a base of a that b doesn't have
+	remove
+};
+
+/*
+ * A path of edits and the number of bases of each side it covers.
+ */
+struct window_alignment
+{
+	std::vector<edit_op> ops;
+	std::size_t cost;
+	std::size_t a_bases;
+	std::size_t b_bases;
+};
+
+/*
+ * Cheapest way, in edits, to turn a[ia, ia + la) into a prefix of
+ * b[ib, ib + lb) or the other way around: the path starts at both starts and
+ * ends as soon as either side runs out. The costs are computed 64 bases of a
+ * at a time with Myers' bit-parallel algorithm on match masks built from
+ * packed words, so the work is lb * la / 64 words; only the path itself
+ * looks at single bases. Gaps are placed as far left as they can go.
+ */
+template<class A, class B>
+window_alignment align_window(const A& a, std::size_t ia, std::size_t la, const B& b, std::size_t ib, std::size_t lb)
+{
+	using detail::align_block_bases;
+	auto blocks = (la + align_block_bases - 1) / align_block_bases;
+
+	std::array<std::vector<std::uint64_t>, 4> matches;
+	for (std::size_t c = 0; c < matches.size(); ++c)
+	{
+		matches[c].resize(blocks);
+		for (std::size_t k = 0; k < blocks; ++k)
+			matches[c][k] = detail::match_mask(a, ia + k * align_block_bases, static_cast<base>(c));
+	}
+
+	// vertical deltas of every column j, blocks words each, and the cost at
+	// the top of each block; column 0 rises by one every row
+	std::vector<std::uint64_t> pv((lb + 1) * blocks, ~std::uint64_t{0});
+	std::vector<std::uint64_t> mv((lb + 1) * blocks, 0);
+	std::vector<std::size_t> top((lb + 1) * blocks);
+	for (std::size_t k = 0; k < blocks; ++k)
+		top[k] = k * align_block_bases;
+
+	packed_word text = 0;
+	for (std::size_t j = 1; j <= lb; ++j)
+	{
+		auto t = (j - 1) % word_bases;
+		if (t == 0)
+			text = b.word_at(ib + j - 1);
+		auto c = static_cast<std::size_t>(text >> (2 * (word_bases - 1 - t))) & 3;
+
+		// the top row costs j, one more than the column before
+		int carry = 1;
+		auto value = j;
+		for (std::size_t k = 0; k < blocks; ++k)
+		{
+			auto at = j * blocks + k;
+			top[at] = value;
+			carry = detail::myers_block(pv[at - blocks], mv[at - blocks], matches[c][k], carry, pv[at], mv[at]);
+			value += static_cast<std::size_t>(__builtin_popcountll(pv[at])) - static_cast<std::size_t>(__builtin_popcountll(mv[at]));
+		}
+	}
+
+	// cell (i, j) covers a[0, i) and b[0, j)
+	auto cell = [&](std::size_t i, std::size_t j) {
+		auto k = i / align_block_bases;
+		auto rows = i % align_block_bases;
+		if (k == blocks || (rows == 0 && k > 0))
+		{
+			// the bottom of block k - 1
+			k -= 1;
+			rows = align_block_bases;
+		}
+		if (blocks == 0)
+			return j;
+		auto at = j * blocks + k;
+		auto mask = rows == align_block_bases ? ~std::uint64_t{0} : (std::uint64_t{1} << rows) - 1;
+		return top[at] + static_cast<std::size_t>(__builtin_popcountll(pv[at] & mask)) -
+				static_cast<std::size_t>(__builtin_popcountll(mv[at] & mask));
+	};
+
+	// cheapest cell where one side has run out; ties go to the longer path
+	std::size_t end_i = 0, end_j = 0;
+	auto end_cost = std::numeric_limits<std::size_t>::max();
+	auto consider = [&](std::size_t i, std::size_t j) {
+		auto value = cell(i, j);
+		if (value < end_cost || (value == end_cost && i + j > end_i + end_j))
+		{
+			end_cost = value;
+			end_i = i;
+			end_j = j;
+		}
+	};
+	for (std::size_t j = 0; j <= lb; ++j)
+		consider(la, j);
+	for (std::size_t i = 0; i <= la; ++i)
+		consider(i, lb);
+
+	window_alignment result{ {}, end_cost, end_i, end_j };
+	result.ops.reserve(end_i + end_j);
+	auto i = end_i;
+	auto j = end_j;
+	while (i > 0 || j > 0)
+	{
+		auto here = cell(i, j);
+		if (i > 0 && j > 0)
+		{
+			bool same = a.at(ia + i - 1) == b.at(ib + j - 1);
+			if (cell(i - 1, j - 1) + !same == here)
+			{
+				result.ops.push_back(same ? edit_op::match : edit_op::substitute);
+				--i;
+				--j;
+				continue;
+			}
+		}
+		if (i > 0 && cell(i - 1, j) + 1 == here)
+		{
+			result.ops.push_back(edit_op::remove);
+			--i;
+			continue;
+		}
+		result.ops.push_back(edit_op::insert);
+		--j;
+	}
+	std::reverse(result.ops.begin(), result.ops.end());
+	return result;
+}
+
+/*
+ * The differences between a[ra] and b[rb], walked from both starts, and
+ * where the walk stopped because one side ran out.
+ */
+struct alignment
+{
+	std::vector<difference> diffs;
+	std::size_t a_end;
+	std::size_t b_end;
+};
+
+namespace detail
+{
+
+inline void append_difference(std::vector<difference>& diffs, const difference& diff)
+{
+	if (!diffs.empty())
+	{
+		auto& prev = diffs.back();
+		if (prev.kind == diff.kind && prev.a.last == diff.a.first && prev.b.last == diff.b.first)
+		{
+			prev.a.last = diff.a.last;
+			prev.b.last = diff.b.last;
+			return;
+		}
+	}
+	diffs.push_back(diff);
+}
+
+}
+
+/*
+ * Where a[ra.first] is found in b near b[rb.first], by voting on the
+ * diagonal of 20-mer seeds from the next Kbase of a. Used to pick up the
+ * diagonal again after indels further up the chromosome, or after one too
+ * long for align_window(). Returns rb.first if the seeds don't agree on
+ * anything.
+ */
+template<class A, class B>
+std::size_t resync(const A& a, base_range ra, const B& b, base_range rb)
+{
+	auto window = std::min(ra.size(), detail::resync_window_bases);
+	if (window < detail::resync_kmer_bases)
+		return rb.first;
+
+	const kmer_index index(a, ra.first, ra.first + window, detail::resync_kmer_bases);
+	auto from = rb.first - std::min(rb.first, detail::resync_slack_bases);
+	auto to = std::min(rb.last, rb.first + window + detail::resync_slack_bases);
+	auto best = best_diagonal(index, b, from, to, 8, detail::resync_stride);
+	if (best.second < window / detail::resync_stride / 4 || best.first < 0)
+		return rb.first;
+	return static_cast<std::size_t>(best.first);
+}
+
+/*
+ * Compares a[ra] with b[rb] like compare_packed(), but follows insertions
+ * and deletions. Bases are compared word-wise until a mismatch; isolated
+ * mismatches are substitutions, while a dense cluster of them is aligned
+ * with align_window() and, if that finds a cheap path through an indel, the
+ * walk carries on from the end of that path on the new diagonal. An indel
+ * too long for that is found by resync() seeding ahead of the cluster, up to
+ * detail::resync_slack_bases long; the walk jumps to the seeds' diagonal if
+ * the bases there line up. Anything else shows up as substitutions.
+ */
+template<class A, class B>
+alignment align_packed(const A& a, base_range ra, const B& b, base_range rb, std::size_t chromosome = 0)
+{
+	alignment result{ {}, ra.first, rb.first };
+	auto& pa = result.a_end;
+	auto& pb = result.b_end;
+
+	// after a cluster nothing explains, the bases up to plain_until aren't
+	// aligned again. The stretch doubles with every such cluster in a row, so
+	// long unrelated stretches cost little more than comparing them.
+	std::size_t plain_until = 0;
+	auto plain_bases = detail::resync_window_bases;
+	while (pa < ra.last && pb < rb.last)
+	{
+		auto length = std::min(ra.last - pa, rb.last - pb);
+		auto same = find_mismatch(a, pa, b, pb, length);
+		pa += same;
+		pb += same;
+		if (same == length)
+			break;
+		if (same >= 2 * word_bases)
+			plain_bases = detail::resync_window_bases;
+
+		if (pa >= plain_until && detail::mismatch_cluster(a, pa, b, pb, length - same))
+		{
+			auto la = std::min(ra.last - pa, detail::align_window_bases);
+			auto lb = std::min(rb.last - pb, detail::align_window_bases);
+			auto path = align_window(a, pa, la, b, pb, lb);
+			bool shifted = std::any_of(path.ops.begin(), path.ops.end(),
+					[](edit_op op) { return op == edit_op::insert || op == edit_op::remove; });
+
+			// an indel explains the cluster if the path through it is mostly
+			// matches and far cheaper than staying on the diagonal
+			if (shifted && 16 * path.cost <= path.a_bases + path.b_bases &&
+					2 * path.cost <= detail::count_mismatches(a, pa, b, pb, std::min(la, lb)))
+			{
+				for (auto op : path.ops)
+				{
+					switch (op)
+					{
+						case edit_op::match:
+							++pa;
+							++pb;
+							break;
+						case edit_op::substitute:
+							detail::append_difference(result.diffs, { chromosome, { pa, pa + 1 }, { pb, pb + 1 }, difference_kind::substitution });
+							++pa;
+							++pb;
+							break;
+						case edit_op::insert:
+							detail::append_difference(result.diffs, { chromosome, { pa, pa }, { pb, pb + 1 }, difference_kind::insertion });
+							++pb;
+							break;
+						case edit_op::remove:
+							detail::append_difference(result.diffs, { chromosome, { pa, pa + 1 }, { pb, pb }, difference_kind::deletion });
+							++pa;
+							break;
+					}
+				}
+				continue;
+			}
+
+			// a longer indel: jump to the diagonal the seeds ahead agree on
+			auto next = resync(a, { pa, ra.last }, b, { pb, rb.last });
+			if (next > pb && next < rb.last &&
+					!detail::mismatch_cluster(a, pa, b, next, std::min(ra.last - pa, rb.last - next)))
+			{
+				detail::append_difference(result.diffs, { chromosome, { pa, pa }, { pb, next }, difference_kind::insertion });
+				pb = next;
+				continue;
+			}
+			auto skip = pb - std::min(next, pb);
+			if (skip != 0 && skip < ra.last - pa &&
+					!detail::mismatch_cluster(a, pa + skip, b, pb, std::min(ra.last - pa - skip, rb.last - pb)))
+			{
+				detail::append_difference(result.diffs, { chromosome, { pa, pa + skip }, { pb, pb }, difference_kind::deletion });
+				pa += skip;
+				continue;
+			}
+			plain_until = pa + plain_bases;
+			plain_bases = std::min(2 * plain_bases, detail::max_plain_bases);
+		}
+
+		auto run = find_match(a, pa, b, pb, length - same);
+		detail::append_difference(result.diffs, { chromosome, { pa, pa + run }, { pb, pb + run }, difference_kind::substitution });
+		pa += run;
+		pb += run;
+	}
+	return result;
+}
+
+}
@@ -1,13 +1,19 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <array>
 #include <ostream>
 
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
 namespace dna
 {
 
-enum class base
+enum class base : std::uint8_t
 {
 	adenine,
 	cytosine,
@@ -38,9 +44,13 @@ constexpr char to_char(base value)
 	}
 }
 
+/*
+ * Complements all four bases of a packed byte. A (0) pairs with T (3) and
+ * C (1) with G (2), so every base is complemented by flipping both its bits.
+ */
 constexpr std::byte complement_packed(std::byte packed)
 {
-	return packed ^ static_cast<std::byte>(0);
+	return packed ^ static_cast<std::byte>(0xff);
 }
 
 constexpr base complement(enum base base)
@@ -68,6 +78,181 @@ constexpr packed_bases unpack(std::byte b)
 			static_cast<dna::base>(b & std::byte{0x3}) });
 }
 
+/*
+ * Base `index` (0..3) of a packed byte, without building the other three.
+ */
+constexpr base unpack_at(std::byte b, std::size_t index)
+{
+	return static_cast<dna::base>((b >> (6 - 2 * index)) & std::byte{0x3});
+}
+
+namespace detail
+{
+
+constexpr std::array<packed_bases, 256> make_unpack_table()
+{
+	std::array<packed_bases, 256> table{};
+	for (std::size_t i = 0; i < table.size(); ++i)
+		table[i] = unpack(static_cast<std::byte>(i));
+	return table;
+}
+
+#if defined(__AVX2__)
+/*
+ * Every input byte is spread over four output lanes, then each lane keeps the
+ * nibble that holds its base and looks the base up in a 16-entry table.
+ * 8 packed bytes become 32 bases per step, so a 64 byte cache line is 8 steps.
+ */
+inline std::size_t unpack_range_simd(const std::byte* bytes, std::size_t count, base* out)
+{
+	const __m256i spread = _mm256_setr_epi8(
+			0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+			4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+	const __m256i high_nibble = _mm256_set1_epi32(0x0000ffff);
+	const __m256i even_lane = _mm256_set1_epi16(0x00ff);
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+	const __m256i upper_pair = _mm256_setr_epi8(
+			0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+			0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+	const __m256i lower_pair = _mm256_setr_epi8(
+			0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3,
+			0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3);
+
+	std::size_t done = 0;
+	for (; done + 8 <= count; done += 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, bytes + done, sizeof(word));
+
+		__m256i x = _mm256_shuffle_epi8(_mm256_set1_epi64x(static_cast<long long>(word)), spread);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+		__m256i lo = _mm256_and_si256(x, nibble);
+		__m256i sel = _mm256_blendv_epi8(lo, hi, high_nibble);
+		__m256i res = _mm256_blendv_epi8(
+				_mm256_shuffle_epi8(lower_pair, sel),
+				_mm256_shuffle_epi8(upper_pair, sel),
+				even_lane);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + done * packed_size::value), res);
+	}
+	return done;
+}
+#elif defined(__SSSE3__)
+/*
+ * Same as the AVX2 kernel at half the width: 4 packed bytes become 16 bases.
+ */
+inline std::size_t unpack_range_simd(const std::byte* bytes, std::size_t count, base* out)
+{
+	const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+	const __m128i high_nibble = _mm_set1_epi32(0x0000ffff);
+	const __m128i even_lane = _mm_set1_epi16(0x00ff);
+	const __m128i nibble = _mm_set1_epi8(0x0f);
+	const __m128i upper_pair = _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+	const __m128i lower_pair = _mm_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3);
+
+	std::size_t done = 0;
+	for (; done + 4 <= count; done += 4)
+	{
+		std::uint32_t word;
+		std::memcpy(&word, bytes + done, sizeof(word));
+
+		__m128i x = _mm_shuffle_epi8(_mm_cvtsi32_si128(static_cast<int>(word)), spread);
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+		__m128i lo = _mm_and_si128(x, nibble);
+		__m128i sel = _mm_or_si128(_mm_and_si128(high_nibble, hi), _mm_andnot_si128(high_nibble, lo));
+		__m128i res = _mm_or_si128(
+				_mm_and_si128(even_lane, _mm_shuffle_epi8(upper_pair, sel)),
+				_mm_andnot_si128(even_lane, _mm_shuffle_epi8(lower_pair, sel)));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + done * packed_size::value), res);
+	}
+	return done;
+}
+#else
+inline std::size_t unpack_range_simd(const std::byte*, std::size_t, base*)
+{
+	return 0;
+}
+#endif
+
+}
+
+/*
+ * All four bases of every possible packed byte.
+ */
+inline constexpr std::array<packed_bases, 256> unpack_table = detail::make_unpack_table();
+
+/*
+ * Decode `count` packed bytes into `count * 4` bases at `out`.
+ * Uses the SIMD kernel when the target supports it and the lookup table for the remainder.
+ */
+inline void unpack_range(const std::byte* bytes, std::size_t count, base* out)
+{
+	std::size_t done = detail::unpack_range_simd(bytes, count, out);
+	for (; done < count; ++done)
+	{
+		const auto& bases = unpack_table[std::to_integer<std::size_t>(bytes[done])];
+		std::memcpy(out + done * packed_size::value, bases.data(), sizeof(bases));
+	}
+}
+
+/*
+ * 32 packed bases in one 64-bit word. The first base is held in the two most
+ * significant bits so words compare, shift and mask in sequence order.
+ */
+using packed_word = std::uint64_t;
+static constexpr std::size_t word_bases = sizeof(packed_word) * packed_size::value;
+
+/*
+ * Mask that keeps the first `count` bases of a packed_word.
+ */
+constexpr packed_word word_mask(std::size_t count)
+{
+	return count >= word_bases ? ~packed_word{0} : ~(~packed_word{0} >> (2 * count));
+}
+
+namespace detail
+{
+
+inline packed_word load_big_endian(const std::byte* bytes, std::size_t available)
+{
+	packed_word word = 0;
+	if (available >= sizeof(packed_word))
+	{
+		std::memcpy(&word, bytes, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		word = __builtin_bswap64(word);
+#endif
+		return word;
+	}
+
+	for (std::size_t i = 0; i < available; ++i)
+		word |= packed_word{std::to_integer<std::uint8_t>(bytes[i])} << (56 - 8 * i);
+	return word;
+}
+
+}
+
+/*
+ * Bases [index, index + 32) of `count` packed bytes as a packed_word.
+ * `index` does not need to be byte aligned; the two words that straddle it are
+ * funnel shifted together. Bases past the end of the data read as adenine (0).
+ */
+inline packed_word load_packed_word(const std::byte* bytes, std::size_t count, std::size_t index)
+{
+	auto boffset = index / packed_size::value;
+	if (boffset >= count)
+		return 0;
+
+	auto shift = 2 * (index - boffset * packed_size::value);
+	auto word = detail::load_big_endian(bytes + boffset, count - boffset);
+	if (shift == 0)
+		return word;
+
+	auto next = boffset + sizeof(packed_word) < count ? std::to_integer<packed_word>(bytes[boffset + sizeof(packed_word)]) : 0;
+	return (word << shift) | (next >> (8 - shift));
+}
+
 inline std::ostream& operator<<(std::ostream& os, base v)
 {
 	switch (v)
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/*
+ * A minimal benchmark harness in the spirit of Google Benchmark: each case is
+ * run once to warm up and then repeatedly until it has run for at least
+ * `min_seconds` and `min_runs` times. The median run is reported as
+ * throughput in bases per second, and the whole suite can be written as JSON
+ * so two commits measured on the same machine can be diffed.
+ */
+namespace bench
+{
+
+/*
+ * Keeps the compiler from dropping a computation whose result is unused.
+ */
+template<class T>
+inline void keep(const T& value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct result
+{
+	std::string name;
+	std::string input;
+	std::size_t bases;
+	std::size_t runs;
+	double median_seconds;
+	double min_seconds;
+
+	double bases_per_second() const
+	{
+		return median_seconds > 0 ? static_cast<double>(bases) / median_seconds : 0;
+	}
+};
+
+class suite
+{
+	std::vector<result> results_;
+	std::string filter_;
+	double min_seconds_;
+	std::size_t min_runs_;
+
+	static double seconds(std::chrono::steady_clock::duration d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+
+public:
+	explicit suite(std::string filter = {}, double min_seconds = 0.5, std::size_t min_runs = 3) :
+			results_(),
+			filter_(std::move(filter)),
+			min_seconds_(min_seconds),
+			min_runs_(std::max<std::size_t>(min_runs, 1))
+	{ }
+
+	/*
+	 * Whether a case called `name` on `input` passes the filter, so expensive
+	 * setup can be skipped for cases that won't run.
+	 */
+	bool selected(std::string_view name, std::string_view input) const
+	{
+		return filter_.empty() || (std::string(name) + "/" + std::string(input)).find(filter_) != std::string::npos;
+	}
+
+	/*
+	 * Times f(), which processes `bases` bases per call, and prints one line.
+	 */
+	template<class F>
+	void run(std::string_view name, std::string_view input, std::size_t bases, F&& f)
+	{
+		if (!selected(name, input))
+			return;
+
+		f();
+		std::vector<double> times;
+		double total = 0;
+		while (times.size() < min_runs_ || total < min_seconds_)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			times.push_back(seconds(std::chrono::steady_clock::now() - start));
+			total += times.back();
+		}
+		std::sort(times.begin(), times.end());
+
+		result r{ std::string(name), std::string(input), bases, times.size(), times[times.size() / 2], times.front() };
+		std::printf("%-28s %-6s %12.3f ms %10.3f Gbases/s  (%zu runs)\n",
+				r.name.c_str(), r.input.c_str(), r.median_seconds * 1e3, r.bases_per_second() / 1e9, r.runs);
+		std::fflush(stdout);
+		results_.push_back(std::move(r));
+	}
+
+	const std::vector<result>& results() const noexcept
+	{
+		return results_;
+	}
+
+	void write_json(std::ostream& out) const
+	{
+		auto quoted = [](const std::string& s) {
+			std::string q = "\"";
+			for (auto c : s)
+			{
+				if (c == '"' || c == '\\')
+					q += '\\';
+				q += c;
+			}
+			return q + '"';
+		};
+
+		out << "{\n  \"context\": {\n"
+				<< "    \"threads\": " << std::thread::hardware_concurrency() << ",\n"
+				<< "    \"compiler\": " << quoted(__VERSION__) << ",\n"
+#ifdef NDEBUG
+				<< "    \"assertions\": false\n"
+#else
+				<< "    \"assertions\": true\n"
+#endif
+				<< "  },\n  \"benchmarks\": [";
+		for (std::size_t i = 0; i < results_.size(); ++i)
+		{
+			const auto& r = results_[i];
+			out << (i == 0 ? "\n" : ",\n")
+					<< "    { \"name\": " << quoted(r.name) << ", \"input\": " << quoted(r.input)
+					<< ", \"bases\": " << r.bases << ", \"runs\": " << r.runs
+					<< ", \"median_ns\": " << static_cast<long long>(r.median_seconds * 1e9)
+					<< ", \"min_ns\": " << static_cast<long long>(r.min_seconds * 1e9)
+					<< ", \"bases_per_second\": " << static_cast<long long>(r.bases_per_second()) << " }";
+		}
+		out << "\n  ]\n}\n";
+	}
+};
+
+}
@@ -0,0 +1,47 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "sequence_buffer.hpp"
+
+/*
+ * Counts the bases of a synthetic 100M base buffer once through the per-base
+ * iterator and once through the block iterator, and reports bases/second.
+ */
+
+template<class F>
+double bases_per_second(std::size_t bases, F&& f)
+{
+	auto start = std::chrono::steady_clock::now();
+	f();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(bases) / elapsed.count();
+}
+
+int main()
+{
+	constexpr std::size_t bases = 100'000'000;
+
+	std::vector<std::byte> data(bases / dna::packed_size::value);
+	std::mt19937_64 rng(42);
+	for (auto& b : data)
+		b = static_cast<std::byte>(rng());
+
+	dna::sequence_buffer<std::vector<std::byte>> buf(std::move(data));
+
+	std::array<std::size_t, 4> per_base{};
+	auto slow = bases_per_second(buf.size(), [&]() {
+		for (auto b : buf)
+			per_base[static_cast<std::size_t>(b)]++;
+	});
+
+	std::array<std::size_t, 4> per_block{};
+	auto fast = bases_per_second(buf.size(), [&]() {
+		per_block = dna::histogram(buf);
+	});
+
+	std::printf("per-base iterator: %10.3f Gbases/s\n", slow / 1e9);
+	std::printf("block iterator:    %10.3f Gbases/s\n", fast / 1e9);
+	std::printf("speedup:           %10.1fx\n", fast / slow);
+	return per_base == per_block ? 0 : 1;
+}
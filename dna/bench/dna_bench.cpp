@@ -0,0 +1,249 @@
+#include <array>
+#include <barrier>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "person.hpp"
+#include "sequence_buffer.hpp"
+#include "synthetic_genome.hpp"
+
+/*
+ * Times the hot paths on synthetic chromosomes of 1M bases, 46M (chromosome
+ * 21) and 249M (chromosome 1):
+ *
+ *   dna_bench [--inputs 1M,46M,249M] [--filter TEXT] [--min-time SECONDS]
+ *             [--runs N] [--json PATH]
+ *
+ * The JSON written by --json is meant to be diffed between commits measured
+ * on the same machine.
+ */
+
+namespace
+{
+
+struct input
+{
+	std::string_view name;
+	std::size_t bases;
+};
+
+constexpr std::array<input, 3> inputs = { {
+	{ "1M", 1'000'000 },
+	{ "46M", dna::synthetic::chromosome_bases[20] },
+	{ "249M", dna::synthetic::chromosome_bases[0] },
+} };
+
+/*
+ * Counts what is written to it and throws it away.
+ */
+class null_buffer : public std::streambuf
+{
+	std::size_t count_ = 0;
+protected:
+	int_type overflow(int_type c) override
+	{
+		++count_;
+		return c;
+	}
+
+	std::streamsize xsputn(const char*, std::streamsize n) override
+	{
+		count_ += static_cast<std::size_t>(n);
+		return n;
+	}
+public:
+	std::size_t count() const noexcept
+	{
+		return count_;
+	}
+};
+
+/*
+ * A chromosome of about `bases` bases with telomeres at both ends.
+ */
+std::vector<std::byte> chromosome(std::size_t bases)
+{
+	return dna::synthetic::add_telomeres(dna::synthetic::random_body(bases, bases), {}, 1);
+}
+
+void run_input(bench::suite& suite, const input& in)
+{
+	using packed = dna::sequence_buffer<std::vector<std::byte>>;
+
+	auto data = chromosome(in.bases);
+	packed buf(data);
+	auto bases = buf.size();
+
+	suite.run("sequence_buffer::at", in.name, bases, [&]() {
+		std::size_t sum = 0;
+		for (std::size_t i = 0; i < buf.size(); ++i)
+			sum += static_cast<std::size_t>(buf.at(i));
+		bench::keep(sum);
+	});
+
+	suite.run("sequence_buffer::iterator", in.name, bases, [&]() {
+		std::array<std::size_t, 4> counts{};
+		for (auto b : buf)
+			counts[static_cast<std::size_t>(b)]++;
+		bench::keep(counts);
+	});
+
+	suite.run("sequence_buffer::blocks", in.name, bases, [&]() {
+		bench::keep(dna::histogram(buf));
+	});
+
+	suite.run("operator<<", in.name, bases, [&]() {
+		null_buffer sink;
+		std::ostream out(&sink);
+		out << buf;
+		bench::keep(sink.count());
+	});
+
+	suite.run("block_tree::build", in.name, bases, [&]() {
+		bench::keep(dna::block_tree::build(buf, { 0, bases }).root());
+	});
+
+	if (suite.selected("HelixStream::read/contended", in.name))
+	{
+		// readers start once and are released for every run, so only the reads are timed
+		dna::HelixStream stream(data, 64 * 1024);
+		auto threads = std::max(2u, std::thread::hardware_concurrency());
+		std::barrier start(threads + 1);
+		std::barrier done(threads + 1);
+		bool stop = false;
+		std::vector<std::array<std::size_t, 4>> counts(threads);
+		std::vector<std::thread> readers;
+		for (unsigned t = 0; t < threads; ++t)
+		{
+			readers.emplace_back([&, t]() {
+				while (true)
+				{
+					start.arrive_and_wait();
+					if (stop)
+						return;
+					std::array<std::size_t, 4> local{};
+					while (true)
+					{
+						auto chunk = stream.read();
+						if (chunk.size() == 0)
+							break;
+						auto h = dna::histogram(chunk);
+						for (std::size_t b = 0; b < h.size(); ++b)
+							local[b] += h[b];
+					}
+					counts[t] = local;
+					done.arrive_and_wait();
+				}
+			});
+		}
+
+		suite.run("HelixStream::read/contended", in.name, bases, [&]() {
+			stream.seek(0);
+			start.arrive_and_wait();
+			done.arrive_and_wait();
+			bench::keep(counts);
+		});
+
+		stop = true;
+		start.arrive_and_wait();
+		for (auto& reader : readers)
+			reader.join();
+	}
+
+	if (suite.selected("Person", in.name))
+	{
+		// the input split over 23 chromosomes
+		std::vector<std::vector<std::byte>> chromosomes(23);
+		auto share = data.size() / chromosomes.size();
+		for (std::size_t i = 0; i < chromosomes.size(); ++i)
+			chromosomes[i].assign(data.begin() + static_cast<long>(i * share), data.begin() + static_cast<long>((i + 1) * share));
+		suite.run("Person", in.name, share * chromosomes.size() * dna::packed_size::value, [&]() {
+			dna::Person person(chromosomes);
+			bench::keep(person.chromosome(0).size());
+		});
+	}
+
+	dna::HelixStream stream(data, 512);
+	auto head = static_cast<std::size_t>(dna::Person::getTelomereBasesCountBegin(stream));
+	auto tail = static_cast<std::size_t>(dna::Person::getTelomereBasesCountEnd(stream));
+	suite.run("getTelomereBasesCountBegin", in.name, head, [&]() {
+		bench::keep(dna::Person::getTelomereBasesCountBegin(stream));
+	});
+	suite.run("getTelomereBasesCountEnd", in.name, tail, [&]() {
+		bench::keep(dna::Person::getTelomereBasesCountEnd(stream));
+	});
+}
+
+void usage()
+{
+	std::fprintf(stderr,
+			"usage: dna_bench [--inputs 1M,46M,249M] [--filter TEXT] [--min-time SECONDS] [--runs N] [--json PATH]\n");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	std::string selected_inputs = "1M,46M,249M";
+	std::string filter;
+	std::string json;
+	double min_time = 0.5;
+	std::size_t runs = 3;
+
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string_view flag = argv[i];
+			if (flag == "--help" || flag == "-h")
+			{
+				usage();
+				return 0;
+			}
+			if (i + 1 == argc)
+				throw std::invalid_argument("missing value for " + std::string(flag));
+			std::string value = argv[++i];
+
+			if (flag == "--inputs")
+				selected_inputs = value;
+			else if (flag == "--filter")
+				filter = value;
+			else if (flag == "--json")
+				json = value;
+			else if (flag == "--min-time")
+				min_time = std::stod(value);
+			else if (flag == "--runs")
+				runs = std::stoull(value);
+			else
+				throw std::invalid_argument("unknown option " + std::string(flag));
+		}
+
+		bench::suite suite(filter, min_time, runs);
+		for (const auto& in : inputs)
+		{
+			if (("," + selected_inputs + ",").find("," + std::string(in.name) + ",") != std::string::npos)
+				run_input(suite, in);
+		}
+
+		if (!json.empty())
+		{
+			std::ofstream out(json, std::ios::trunc);
+			suite.write_json(out);
+			if (!out)
+				throw std::runtime_error("unable to write " + json);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "dna_bench: %s\n", e.what());
+		usage();
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include "person.hpp"
+#include "sequence_view.hpp"
+
+namespace dna
+{
+
+namespace detail
+{
+
+// gcc warns that the value may differ between -mtune settings; that only
+// moves padding, all of this is compiled together
+#ifdef __cpp_lib_hardware_interference_size
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+constexpr std::size_t cache_line_bytes = std::hardware_destructive_interference_size;
+#pragma GCC diagnostic pop
+#else
+constexpr std::size_t cache_line_bytes = 64;
+#endif
+
+}
+
+/*
+ * One piece of a chromosome handed out by a chunk_dispenser. Chunk `index`
+ * covers bases [base_offset, base_offset + chunk size) of the chromosome;
+ * the view additionally holds the overlap bases after that, if any.
+ */
+struct chunk
+{
+	std::size_t index;
+	std::size_t base_offset;
+	sequence_view<HelixStream::byte_view> view;
+};
+
+/*
+ * Hands the chunks of a chromosome to any number of threads, each exactly
+ * once. Unlike HelixStream::read() every chunk says where it came from, so
+ * results can be put back in order, and consecutive chunks can overlap by
+ * k - 1 bases so that a k-mer spanning a border is seen whole by the chunk
+ * it starts in.
+ *
+ * Taking a chunk is a single fetch_add on a counter that sits on its own
+ * cache line; everything else is computed from the index. Chunks start on
+ * byte boundaries, so their views take the aligned fast paths.
+ */
+class chunk_dispenser
+{
+	HelixStream stream_;
+	std::size_t bases_;
+	std::size_t chunk_bases_;
+	std::size_t overlap_;
+	std::size_t count_;
+	alignas(detail::cache_line_bytes) std::atomic<std::size_t> next_;
+
+	static_assert(std::atomic<std::size_t>::is_always_lock_free);
+public:
+	/*
+	 * Chunks of `chunk_bases` bases, rounded up to whole bytes, each extended
+	 * by `overlap` bases into the next one. The stream's data is shared, not
+	 * copied, and its position is left alone.
+	 */
+	chunk_dispenser(const HelixStream& stream, std::size_t chunk_bases, std::size_t overlap = 0) :
+			stream_(stream),
+			bases_(static_cast<std::size_t>(stream.size()) * packed_size::value),
+			chunk_bases_((chunk_bases + packed_size::value - 1) / packed_size::value * packed_size::value),
+			overlap_(overlap),
+			count_(0),
+			next_(0)
+	{
+		if (chunk_bases == 0)
+			throw std::invalid_argument("chunks must have at least one base");
+		count_ = (bases_ + chunk_bases_ - 1) / chunk_bases_;
+	}
+
+	chunk_dispenser(const chunk_dispenser&) = delete;
+	chunk_dispenser& operator=(const chunk_dispenser&) = delete;
+
+	/*
+	 * The next chunk nobody has taken yet, or nothing once all are taken.
+	 * Chunks are taken in index order, but with several threads they may
+	 * finish in any order.
+	 */
+	std::optional<chunk> next() noexcept
+	{
+		auto index = next_.fetch_add(1, std::memory_order_relaxed);
+		if (index >= count_)
+			return std::nullopt;
+		return at(index);
+	}
+
+	/*
+	 * Chunk `index`, whether it has been taken or not.
+	 */
+	chunk at(std::size_t index) const noexcept
+	{
+		auto first = index * chunk_bases_;
+		return { index, first, stream_.view(first, chunk_bases_ + overlap_) };
+	}
+
+	/*
+	 * Makes every chunk available again. Not safe while other threads take chunks.
+	 */
+	void reset() noexcept
+	{
+		next_.store(0, std::memory_order_relaxed);
+	}
+
+	std::size_t size() const noexcept
+	{
+		return count_;
+	}
+
+	std::size_t chunk_bases() const noexcept
+	{
+		return chunk_bases_;
+	}
+
+	std::size_t overlap() const noexcept
+	{
+		return overlap_;
+	}
+
+	/*
+	 * Number of bases in the chromosome.
+	 */
+	std::size_t bases() const noexcept
+	{
+		return bases_;
+	}
+};
+
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "difference.hpp"
+#include "fingerprint.hpp"
+#include "kmer.hpp"
+#include "person.hpp"
+#include "shard.hpp"
+#include "telomere.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace dna
+{
+
+namespace detail
+{
+
+constexpr std::size_t compare_chunk_bases = std::size_t{1} << 22;
+
+// seeds used to line up chromosomes that lost their head telomere
+constexpr std::size_t anchor_kmer_bases = 31;
+constexpr std::size_t anchor_sample_bases = 16;
+constexpr std::size_t anchor_window_bases = std::size_t{1} << 20;
+constexpr std::size_t anchor_min_votes = 4;
+
+// seeds used to find a region in another person
+constexpr std::size_t region_kmer_bases = 16;
+
+// how far from its expected position a region is searched for
+constexpr std::size_t region_search_bases = std::size_t{1} << 16;
+
+/*
+ * Parts of [0, length) past the trimmed starts that block hashes don't show
+ * to be equal, or all of it if the trees don't fit the anchor, have
+ * different phases or stop short of `length`. The end is always included,
+ * since the last shard carries the tails.
+ */
+inline std::vector<base_range> changed_pieces(const block_tree& a, const block_tree& b, const alignment_anchor& anchor,
+		std::size_t length)
+{
+	// both trees must hash all `length` bases from their first one
+	auto covers = [&](const block_tree& tree) { return tree.bytes() * packed_size::value >= length + tree.phase(); };
+	if (a.first_base() != anchor.a || b.first_base() != anchor.b || a.phase() != b.phase() ||
+			a.block_bytes() != b.block_bytes() || !covers(a) || !covers(b))
+		return { { 0, length } };
+
+	std::vector<base_range> pieces;
+	auto add = [&](base_range range) {
+		range.last = std::min(range.last, length);
+		if (range.first >= range.last)
+			return;
+		if (!pieces.empty() && pieces.back().last >= range.first)
+			pieces.back().last = std::max(pieces.back().last, range.last);
+		else
+			pieces.push_back(range);
+	};
+	for (auto range : differing_ranges(a, b))
+		add(range);
+	add({ length - std::min(length, a.block_bytes() * packed_size::value), length });
+	return pieces;
+}
+
+}
+
+/*
+ * Lines up two chromosomes by their content rather than by their telomeres.
+ * Every 16th 31-mer of the first Mbase of `ra` is indexed, the first Mbase
+ * of `rb` is slid over the index, and the diagonal most seeds agree on wins.
+ * Returns nothing if too few seeds agree. The cost is one pass over both
+ * windows, however far the starts are apart within them.
+ */
+template<class A, class B>
+std::optional<alignment_anchor> find_anchor(const A& a, base_range ra, const B& b, base_range rb)
+{
+	auto window_a = std::min(ra.size(), detail::anchor_window_bases);
+	auto window_b = std::min(rb.size(), detail::anchor_window_bases);
+	if (window_a < detail::anchor_kmer_bases || window_b < detail::anchor_kmer_bases)
+		return std::nullopt;
+
+	const kmer_index index(a, ra.first, ra.first + window_a, detail::anchor_kmer_bases, detail::anchor_sample_bases);
+	auto best = best_diagonal(index, b, rb.first, rb.first + window_b);
+	if (best.second < std::min(detail::anchor_min_votes, index.size()))
+		return std::nullopt;
+
+	// base ra.first + i of a is base best.first + i of b; start where both are inside their ranges
+	auto diagonal = best.first;
+	auto skip = std::max(static_cast<long>(rb.first) - diagonal, 0L);
+	return alignment_anchor{ ra.first + static_cast<std::size_t>(skip), static_cast<std::size_t>(diagonal + skip) };
+}
+
+/*
+ * Splits the comparison of two people into shards of at most `shard_bases`.
+ * Telomeres are cut off both ends of each chromosome and the remaining bases
+ * are lined up on the trimmed starts. If either chromosome lost its head
+ * telomere they are lined up by find_anchor() instead, and bases ahead of
+ * the anchor are left out like telomeres. Chromosome 23 is left out when one
+ * person has an X and the other a Y (see Person::sex(), which is cached, so
+ * a cohort pays for it once per person).
+ *
+ * If both people already have block hashes (Person::fingerprints() or
+ * load_fingerprints()) and a chromosome is lined up on trimmed starts with
+ * the same phase, only the blocks whose hashes differ are planned, plus the
+ * end; identical stretches are never read.
+ */
+inline std::vector<ComparisonShard> plan_shards(const Person& a, const Person& b,
+		const std::string& id_a, const std::string& id_b, std::size_t shard_bases = detail::compare_chunk_bases,
+		work_stealing_pool& pool = work_stealing_pool::shared())
+{
+	shard_bases = std::max<std::size_t>(shard_bases, 1);
+
+	const auto& trims_a = a.trim_bounds(pool);
+	const auto& trims_b = b.trim_bounds(pool);
+	auto sex_a = a.sex();
+	auto sex_b = b.sex();
+	auto hashes_a = a.known_fingerprints();
+	auto hashes_b = b.known_fingerprints();
+
+	std::vector<ComparisonShard> shards;
+	for (std::size_t index = 0; index < a.chromosomes(); ++index)
+	{
+		const auto& ca = a.chromosome(index);
+		const auto& cb = b.chromosome(index);
+		if (index == a.chromosomes() - 1 && sex_a != sex_b &&
+				sex_a != sex_chromosome::unknown && sex_b != sex_chromosome::unknown)
+			continue;
+
+		auto ra = trims_a[index].bounds;
+		auto rb = trims_b[index].bounds;
+		alignment_anchor anchor{ ra.first, rb.first };
+		if (trims_a[index].head.length == 0 || trims_b[index].head.length == 0)
+		{
+			auto sa = ca.read_at(0, static_cast<std::size_t>(ca.size()));
+			auto sb = cb.read_at(0, static_cast<std::size_t>(cb.size()));
+			if (auto found = find_anchor(sa, ra, sb, rb))
+			{
+				anchor = *found;
+				ra.first = std::min(anchor.a, ra.last);
+				rb.first = std::min(anchor.b, rb.last);
+			}
+		}
+		auto length = std::min(ra.size(), rb.size());
+
+		std::vector<base_range> pieces{ { 0, length } };
+		if (hashes_a && hashes_b && length != 0)
+			pieces = detail::changed_pieces((*hashes_a)[index], (*hashes_b)[index], anchor, length);
+
+		for (auto piece : pieces)
+		{
+			for (auto offset = piece.first; offset == piece.first || offset < piece.last; offset += shard_bases)
+			{
+				auto count = std::min(shard_bases, piece.last - offset);
+				bool last = offset + count >= length;
+				shards.push_back({ id_a, id_b, index,
+						{ ra.first + offset, last ? ra.last : ra.first + offset + count },
+						{ rb.first + offset, last ? rb.last : rb.first + offset + count },
+						anchor });
+			}
+		}
+	}
+	return shards;
+}
+
+/*
+ * Runs shards on local threads with the same map() and reduce() an external
+ * framework would use, so both give identical output.
+ */
+inline partial_diffs run_local(const std::vector<ComparisonShard>& shards, const Person& a, const Person& b,
+		work_stealing_pool& pool = work_stealing_pool::shared())
+{
+	std::vector<partial_diffs> partials(shards.size());
+	pool.parallel_for(0, shards.size(), 1, [&](std::size_t first, std::size_t last) {
+		for (auto i = first; i < last; ++i)
+			partials[i] = map(shards[i], a, b);
+	});
+
+	// reduce pairwise, as a framework would across reducers
+	while (partials.size() > 1)
+	{
+		std::vector<partial_diffs> combined((partials.size() + 1) / 2);
+		pool.parallel_for(0, combined.size(), 1, [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+			{
+				if (2 * i + 1 < partials.size())
+					combined[i] = reduce(partials[2 * i], partials[2 * i + 1]);
+				else
+					combined[i] = std::move(partials[2 * i]);
+			}
+		});
+		partials = std::move(combined);
+	}
+	return partials.empty() ? partial_diffs{} : std::move(partials.front());
+}
+
+/*
+ * Compares every chromosome of two people and returns their differences,
+ * ordered by chromosome and position. See plan_shards() for how chromosomes
+ * are lined up.
+ */
+inline std::vector<difference> compare(const Person& a, const Person& b, work_stealing_pool& pool = work_stealing_pool::shared())
+{
+	return run_local(plan_shards(a, b, "a", "b", detail::compare_chunk_bases, pool), a, b, pool).diffs;
+}
+
+/*
+ * Where a region of one person was found in another, and how they differ.
+ * When the region couldn't be found `anchored` is false and nothing else is set.
+ */
+struct region_match
+{
+	bool anchored;
+	base_range range;
+	std::vector<difference> diffs;
+};
+
+/*
+ * Compares bases `range` of chromosome `chromosome` of `source` against the
+ * same chromosome of every person in `cohort`, returning one match per person.
+ * The region is decoded and indexed once. Each person is first checked at
+ * the position implied by the trimmed starts of both chromosomes; only if
+ * too few seeds agree there is a window around it searched for the diagonal
+ * most seeds agree on. Differences are reported as by compare(), with
+ * `a` ranges in the source and `b` ranges in the cohort member.
+ */
+inline std::vector<region_match> compare_region(const Person& source, std::size_t chromosome, base_range range,
+		std::span<const Person*> cohort, work_stealing_pool& pool = work_stealing_pool::shared())
+{
+	const auto& chrom = source.chromosome(chromosome);
+	auto seq = chrom.read_at(0, static_cast<std::size_t>(chrom.size()));
+	if (range.first > range.last || range.last > seq.size())
+		throw std::invalid_argument("region does not fit the chromosome");
+	if (std::find(cohort.begin(), cohort.end(), nullptr) != cohort.end())
+		throw std::invalid_argument("cohort contains a null person");
+
+	auto k = std::min(detail::region_kmer_bases, range.size());
+	std::vector<region_match> matches(cohort.size());
+	if (k == 0)
+		return matches;
+
+	const kmer_index index(seq, range.first, range.last, k);
+	auto source_start = static_cast<long>(source.trim_begin(chromosome));
+
+	pool.parallel_for(0, cohort.size(), 1, [&](std::size_t first, std::size_t last) {
+		for (auto i = first; i < last; ++i)
+		{
+			const auto& other = *cohort[i];
+			const auto& target = other.chromosome(chromosome);
+			auto other_seq = target.read_at(0, static_cast<std::size_t>(target.size()));
+
+			auto start = static_cast<long>(other.trim_begin(chromosome));
+			auto diagonal = static_cast<long>(range.first) - source_start + start;
+			if (2 * diagonal_votes(index, other_seq, diagonal) < index.size())
+			{
+				auto slack = static_cast<long>(detail::region_search_bases);
+				auto from = static_cast<std::size_t>(std::clamp(diagonal - slack, 0L, static_cast<long>(other_seq.size())));
+				auto to = static_cast<std::size_t>(std::clamp(diagonal + static_cast<long>(range.size()) + slack, 0L, static_cast<long>(other_seq.size())));
+				auto best = best_diagonal(index, other_seq, from, to);
+				if (best.second == 0)
+					continue;
+				diagonal = best.first;
+			}
+
+			// the region may hang over either end of the other chromosome
+			auto skip = static_cast<std::size_t>(std::max(-diagonal, 0L));
+			auto other_first = static_cast<std::size_t>(std::max(diagonal, 0L));
+			auto length = std::min(range.size() - skip, other_seq.size() - std::min(other_first, other_seq.size()));
+
+			ComparisonShard shard{ "", "", chromosome,
+					{ range.first + skip, range.last },
+					{ other_first, other_first + length },
+					{ range.first + skip, other_first } };
+			auto& match = matches[i];
+			match = { true, { other_first, other_first + length }, {} };
+			if (skip > 0)
+				match.diffs.push_back({ chromosome, { range.first, range.first + skip }, { 0, 0 }, difference_kind::unmatched });
+			for (auto& diff : map(shard, source, other).diffs)
+				match.diffs.push_back(diff);
+		}
+	});
+	return matches;
+}
+
+}
@@ -0,0 +1,427 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "difference.hpp"
+#include "mapped_file.hpp"
+#include "person.hpp"
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+/*
+ * Compact binary stream of differences, appended to by any number of
+ * comparison workers and read back through a memory mapping.
+ *
+ *   header  8 bytes "DNADIFF1", uint32 version, uint32 reserved (0), little endian
+ *   then records, each:
+ *     tag byte: kind in bits 0-2, bit 3 new chromosome, bit 4 alternate bases
+ *               follow, bit 5 both ranges have the same length
+ *     [varint chromosome]                        if bit 3
+ *     zigzag varint a.first - previous a.first
+ *     varint a length
+ *     zigzag varint (b.first - a.first) - previous (b.first - a.first)
+ *     [varint b length]                          unless bit 5
+ *     [b length bases, 2 bits each, first base in the high bits]  if bit 4
+ * Varints are LEB128. A new chromosome resets both previous values to zero.
+ * Every batch a worker appends starts with a new chromosome record, so batches
+ * can be written in any order and each decodes on its own. A typical SNP
+ * record takes 4 or 5 bytes.
+ */
+namespace diff_stream
+{
+
+constexpr char magic[8] = { 'D', 'N', 'A', 'D', 'I', 'F', 'F', '1' };
+constexpr std::uint32_t version = 1;
+constexpr std::size_t header_size = 16;
+
+constexpr std::uint8_t kind_mask = 0x07;
+constexpr std::uint8_t new_chromosome = 0x08;
+constexpr std::uint8_t has_alternate = 0x10;
+constexpr std::uint8_t same_length = 0x20;
+
+namespace detail
+{
+
+inline void put_varint(std::vector<std::byte>& out, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<std::byte>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<std::byte>(value));
+}
+
+inline std::uint64_t get_varint(const std::byte*& in, const std::byte* end)
+{
+	std::uint64_t value = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7)
+	{
+		if (in == end)
+			throw std::runtime_error("difference stream is truncated");
+		auto byte = std::to_integer<std::uint64_t>(*in++);
+		value |= (byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+	throw std::runtime_error("difference stream has an overlong number");
+}
+
+constexpr std::uint64_t zigzag(std::int64_t value)
+{
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+constexpr std::int64_t unzigzag(std::uint64_t value)
+{
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+constexpr std::int64_t diagonal(const difference& diff)
+{
+	return static_cast<std::int64_t>(diff.b.first) - static_cast<std::int64_t>(diff.a.first);
+}
+
+/*
+ * Packs bases [first, last) of `seq` 4 to a byte, a word at a time.
+ */
+template<class S>
+void put_bases(std::vector<std::byte>& out, const S& seq, std::size_t first, std::size_t last)
+{
+	auto bytes = (last - first + packed_size::value - 1) / packed_size::value;
+	for (std::size_t k = 0; k < bytes; k += sizeof(packed_word))
+	{
+		auto word = seq.word_at(first + k * packed_size::value);
+		auto bases = std::min<std::size_t>(word_bases, last - first - k * packed_size::value);
+		word &= word_mask(bases);
+		for (std::size_t i = 0; i < std::min(sizeof(packed_word), bytes - k); ++i)
+			out.push_back(static_cast<std::byte>(word >> (56 - 8 * i)));
+	}
+}
+
+}
+
+/*
+ * Encodes one batch. `alternate(diff)` returns the sequence to take the bases
+ * of diff.b from, or nullptr to leave them out.
+ */
+template<class F>
+std::vector<std::byte> encode(std::span<const difference> diffs, F&& alternate)
+{
+	std::vector<std::byte> out;
+	out.reserve(diffs.size() * 6);
+
+	std::size_t chromosome = 0;
+	std::int64_t previous_first = 0;
+	std::int64_t previous_diagonal = 0;
+	for (std::size_t i = 0; i < diffs.size(); ++i)
+	{
+		const auto& diff = diffs[i];
+		auto tag = static_cast<std::uint8_t>(static_cast<std::uint8_t>(diff.kind) & kind_mask);
+		if (i == 0 || diff.chromosome != chromosome)
+		{
+			tag |= new_chromosome;
+			chromosome = diff.chromosome;
+			previous_first = 0;
+			previous_diagonal = 0;
+		}
+		const auto* seq = diff.b.size() != 0 ? alternate(diff) : nullptr;
+		if (seq != nullptr)
+			tag |= has_alternate;
+		if (diff.a.size() == diff.b.size())
+			tag |= same_length;
+
+		out.push_back(static_cast<std::byte>(tag));
+		if (tag & new_chromosome)
+			detail::put_varint(out, chromosome);
+		detail::put_varint(out, detail::zigzag(static_cast<std::int64_t>(diff.a.first) - previous_first));
+		detail::put_varint(out, diff.a.size());
+		detail::put_varint(out, detail::zigzag(detail::diagonal(diff) - previous_diagonal));
+		if ((tag & same_length) == 0)
+			detail::put_varint(out, diff.b.size());
+		if (seq != nullptr)
+			detail::put_bases(out, *seq, diff.b.first, diff.b.last);
+
+		previous_first = static_cast<std::int64_t>(diff.a.first);
+		previous_diagonal = detail::diagonal(diff);
+	}
+	return out;
+}
+
+inline std::vector<std::byte> encode(std::span<const difference> diffs)
+{
+	return encode(diffs, [](const difference&) { return static_cast<const sequence_buffer<HelixStream::byte_view>*>(nullptr); });
+}
+
+}
+
+/*
+ * Appends batches of differences to a difference stream, see diff_stream.
+ * Safe to share between threads: a batch is encoded by the calling thread and
+ * only the write to the file is serialised, so batches never interleave.
+ */
+class diff_writer
+{
+	std::mutex mutex_;
+	std::ofstream out_;
+	std::filesystem::path path_;
+
+	void write(const std::vector<std::byte>& bytes);
+public:
+	explicit diff_writer(const std::filesystem::path& path);
+
+	void append(std::span<const difference> diffs);
+
+	/*
+	 * Also records the bases `b` has in each difference.
+	 */
+	void append(std::span<const difference> diffs, const Person& b);
+
+	void flush();
+};
+
+inline diff_writer::diff_writer(const std::filesystem::path& path) :
+		mutex_(),
+		out_(path, std::ios::binary | std::ios::trunc),
+		path_(path)
+{
+	std::vector<std::byte> header(diff_stream::header_size);
+	for (std::size_t i = 0; i < sizeof(diff_stream::magic); ++i)
+		header[i] = static_cast<std::byte>(diff_stream::magic[i]);
+	for (std::size_t i = 0; i < 4; ++i)
+		header[8 + i] = static_cast<std::byte>(diff_stream::version >> (8 * i));
+	write(header);
+}
+
+inline void diff_writer::write(const std::vector<std::byte>& bytes)
+{
+	out_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!out_)
+		throw std::runtime_error("unable to write " + path_.string());
+}
+
+inline void diff_writer::append(std::span<const difference> diffs)
+{
+	if (diffs.empty())
+		return;
+	auto bytes = diff_stream::encode(diffs);
+	std::lock_guard<std::mutex> lock(mutex_);
+	write(bytes);
+}
+
+inline void diff_writer::append(std::span<const difference> diffs, const Person& b)
+{
+	if (diffs.empty())
+		return;
+
+	std::vector<sequence_buffer<HelixStream::byte_view>> chromosomes;
+	for (std::size_t i = 0; i < b.chromosomes(); ++i)
+		chromosomes.push_back(b.chromosome(i).read_at(0, static_cast<std::size_t>(b.chromosome(i).size())));
+
+	auto bytes = diff_stream::encode(diffs, [&](const difference& diff) {
+		return diff.chromosome < chromosomes.size() && diff.b.last <= chromosomes[diff.chromosome].size() ?
+				&chromosomes[diff.chromosome] : nullptr;
+	});
+	std::lock_guard<std::mutex> lock(mutex_);
+	write(bytes);
+}
+
+inline void diff_writer::flush()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	out_.flush();
+	if (!out_)
+		throw std::runtime_error("unable to write " + path_.string());
+}
+
+/*
+ * One decoded record. `alternate` holds the bases of b when they were
+ * written, and is empty otherwise.
+ */
+struct diff_record
+{
+	difference diff;
+	sequence_buffer<std::span<const std::byte>> alternate;
+};
+
+/*
+ * Maps a difference stream and decodes it lazily while iterating. Opening
+ * only checks the header; malformed records throw std::runtime_error when
+ * they are reached.
+ */
+class diff_reader
+{
+	mapped_file file_;
+public:
+	class iterator
+	{
+		const std::byte* at_;
+		const std::byte* next_;
+		const std::byte* end_;
+		diff_record record_;
+		std::int64_t previous_first_;
+		std::int64_t previous_diagonal_;
+
+		void decode();
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = diff_record;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const diff_record*;
+		using reference = const diff_record&;
+
+		iterator() noexcept;
+		iterator(const std::byte* at, const std::byte* end);
+
+		const diff_record& operator*() const noexcept
+		{
+			return record_;
+		}
+
+		const diff_record* operator->() const noexcept
+		{
+			return &record_;
+		}
+
+		iterator& operator++();
+
+		bool operator==(const iterator& other) const noexcept
+		{
+			return at_ == other.at_;
+		}
+
+		bool operator!=(const iterator& other) const noexcept
+		{
+			return at_ != other.at_;
+		}
+	};
+
+	explicit diff_reader(const std::filesystem::path& path);
+
+	iterator begin() const;
+	iterator end() const;
+
+	/*
+	 * Decodes every record into memory.
+	 */
+	std::vector<difference> read_all() const;
+};
+
+inline diff_reader::diff_reader(const std::filesystem::path& path) :
+		file_(path)
+{
+	if (file_.size() < diff_stream::header_size)
+		throw std::runtime_error("difference stream is truncated");
+	for (std::size_t i = 0; i < sizeof(diff_stream::magic); ++i)
+	{
+		if (file_.data()[i] != static_cast<std::byte>(diff_stream::magic[i]))
+			throw std::runtime_error("not a difference stream");
+	}
+	std::uint32_t version = 0;
+	for (std::size_t i = 0; i < 4; ++i)
+		version |= std::to_integer<std::uint32_t>(file_.data()[8 + i]) << (8 * i);
+	if (version != diff_stream::version)
+		throw std::runtime_error("unsupported difference stream version");
+	file_.advise(access_pattern::sequential);
+}
+
+inline diff_reader::iterator diff_reader::begin() const
+{
+	return iterator(file_.data() + diff_stream::header_size, file_.data() + file_.size());
+}
+
+inline diff_reader::iterator diff_reader::end() const
+{
+	auto end = file_.data() + file_.size();
+	return iterator(end, end);
+}
+
+inline std::vector<difference> diff_reader::read_all() const
+{
+	std::vector<difference> diffs;
+	for (const auto& record : *this)
+		diffs.push_back(record.diff);
+	return diffs;
+}
+
+inline diff_reader::iterator::iterator() noexcept :
+		at_(nullptr),
+		next_(nullptr),
+		end_(nullptr),
+		record_{ {}, { std::span<const std::byte>() } },
+		previous_first_(0),
+		previous_diagonal_(0)
+{ }
+
+inline diff_reader::iterator::iterator(const std::byte* at, const std::byte* end) :
+		at_(at),
+		next_(at),
+		end_(end),
+		record_{ {}, { std::span<const std::byte>() } },
+		previous_first_(0),
+		previous_diagonal_(0)
+{
+	if (at_ != end_)
+		decode();
+}
+
+inline diff_reader::iterator& diff_reader::iterator::operator++()
+{
+	at_ = next_;
+	if (at_ != end_)
+		decode();
+	return *this;
+}
+
+inline void diff_reader::iterator::decode()
+{
+	// at_ is the start of the current record, next_ ends up after it
+	auto tag = std::to_integer<std::uint8_t>(*at_);
+	const auto* in = at_ + 1;
+	auto& diff = record_.diff;
+	if (tag & diff_stream::new_chromosome)
+	{
+		diff.chromosome = static_cast<std::size_t>(diff_stream::detail::get_varint(in, end_));
+		previous_first_ = 0;
+		previous_diagonal_ = 0;
+	}
+	auto kind = tag & diff_stream::kind_mask;
+	if (kind > static_cast<int>(difference_kind::deletion))
+		throw std::runtime_error("difference stream has an unknown kind");
+	diff.kind = static_cast<difference_kind>(kind);
+
+	auto first = previous_first_ + diff_stream::detail::unzigzag(diff_stream::detail::get_varint(in, end_));
+	auto a_size = diff_stream::detail::get_varint(in, end_);
+	auto diagonal = previous_diagonal_ + diff_stream::detail::unzigzag(diff_stream::detail::get_varint(in, end_));
+	auto b_size = tag & diff_stream::same_length ? a_size : diff_stream::detail::get_varint(in, end_);
+	if (first < 0 || first + diagonal < 0)
+		throw std::runtime_error("difference stream has a negative position");
+
+	diff.a = { static_cast<std::size_t>(first), static_cast<std::size_t>(first) + a_size };
+	diff.b = { static_cast<std::size_t>(first + diagonal), static_cast<std::size_t>(first + diagonal) + b_size };
+	previous_first_ = first;
+	previous_diagonal_ = diagonal;
+
+	std::span<const std::byte> bases;
+	if (tag & diff_stream::has_alternate)
+	{
+		auto bytes = (b_size + packed_size::value - 1) / packed_size::value;
+		if (static_cast<std::size_t>(end_ - in) < bytes)
+			throw std::runtime_error("difference stream is truncated");
+		bases = { in, bytes };
+		in += bytes;
+	}
+	record_.alternate = sequence_buffer<std::span<const std::byte>>(bases, bases.empty() ? 0 : b_size);
+	next_ = in;
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+enum class difference_kind
+{
+	// both sides have bases here, and they differ
+	substitution,
+	// bases at the end of one side that the other side has no counterpart for
+	unmatched,
+	// bases b has that a doesn't; the range in a is empty
+	insertion,
+	// bases a has that b doesn't; the range in b is empty
+	deletion
+};
+
+inline std::ostream& operator<<(std::ostream& os, difference_kind kind)
+{
+	switch (kind)
+	{
+		case difference_kind::substitution:
+			return os << "substitution";
+		case difference_kind::insertion:
+			return os << "insertion";
+		case difference_kind::deletion:
+			return os << "deletion";
+		default:
+			return os << "unmatched";
+	}
+}
+
+/*
+ * One interesting distinction between two people. Ranges are base positions
+ * in each person's own chromosome, so the sequence can be read back from
+ * either side. One of the ranges is empty for unmatched differences, insertions
+ * and deletions.
+ */
+struct difference
+{
+	std::size_t chromosome;
+	base_range a;
+	base_range b;
+	difference_kind kind;
+
+	constexpr bool operator==(const difference& other) const noexcept
+	{
+		return chromosome == other.chromosome && a == other.a && b == other.b && kind == other.kind;
+	}
+
+	constexpr bool operator!=(const difference& other) const noexcept
+	{
+		return !operator==(other);
+	}
+};
+
+inline std::ostream& operator<<(std::ostream& os, const difference& diff)
+{
+	return os << "chromosome " << (diff.chromosome + 1) << ' ' << diff.a << " / " << diff.b << ' ' << diff.kind;
+}
+
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "mapped_file.hpp"
+#include "sequence_buffer.hpp"
+#include "trim_index.hpp"
+#include "xxhash.hpp"
+
+namespace dna
+{
+
+namespace detail
+{
+
+constexpr std::size_t fingerprint_block_bytes = std::size_t{1} << 16;
+
+}
+
+/*
+ * A Merkle tree of XXH64 hashes over the real bases of one chromosome. The
+ * leaves hash blocks of packed bytes counted from the byte that holds the
+ * first base after the head telomere, so two people whose trimmed starts sit
+ * at the same position within a byte (the same phase) have blocks holding
+ * the same bases wherever their chromosomes agree. Each parent hashes its
+ * one or two children, so equal hashes at any level mean equal bytes below.
+ */
+class block_tree
+{
+	std::size_t first_;
+	std::size_t block_bytes_;
+	std::size_t bytes_;
+	std::vector<std::vector<std::uint64_t>> levels_;
+
+	void build_parents();
+public:
+	block_tree() :
+			first_(0),
+			block_bytes_(detail::fingerprint_block_bytes),
+			bytes_(0),
+			levels_(1)
+	{ }
+
+	/*
+	 * The tree over `leaves`, the block hashes of `bytes` bytes starting
+	 * with the one that holds base `first`.
+	 */
+	block_tree(std::size_t first, std::size_t block_bytes, std::size_t bytes, std::vector<std::uint64_t> leaves);
+
+	/*
+	 * Hashes bases `trimmed` of `seq` in blocks of `block_bytes`.
+	 */
+	template<class S>
+	static block_tree build(const S& seq, base_range trimmed, std::size_t block_bytes = detail::fingerprint_block_bytes);
+
+	/*
+	 * First real base of the chromosome, as trimmed when the tree was built.
+	 */
+	std::size_t first_base() const noexcept
+	{
+		return first_;
+	}
+
+	/*
+	 * Position of the first real base within its byte.
+	 */
+	std::size_t phase() const noexcept
+	{
+		return first_ % packed_size::value;
+	}
+
+	std::size_t block_bytes() const noexcept
+	{
+		return block_bytes_;
+	}
+
+	/*
+	 * Number of bytes hashed.
+	 */
+	std::size_t bytes() const noexcept
+	{
+		return bytes_;
+	}
+
+	const std::vector<std::uint64_t>& leaves() const noexcept
+	{
+		return levels_.front();
+	}
+
+	/*
+	 * Hashes of level `index`; level 0 are the leaves, the last level the root.
+	 */
+	const std::vector<std::uint64_t>& level(std::size_t index) const
+	{
+		return levels_.at(index);
+	}
+
+	std::size_t height() const noexcept
+	{
+		return levels_.size();
+	}
+
+	std::uint64_t root() const noexcept
+	{
+		return levels_.back().empty() ? 0 : levels_.back().front();
+	}
+};
+
+inline block_tree::block_tree(std::size_t first, std::size_t block_bytes, std::size_t bytes, std::vector<std::uint64_t> leaves) :
+		first_(first),
+		block_bytes_(std::max<std::size_t>(block_bytes, 1)),
+		bytes_(bytes),
+		levels_()
+{
+	if (leaves.size() != (bytes_ + block_bytes_ - 1) / block_bytes_)
+		throw std::invalid_argument("block hashes do not cover the bytes");
+	levels_.push_back(std::move(leaves));
+	build_parents();
+}
+
+inline void block_tree::build_parents()
+{
+	for (std::size_t level = 1; levels_.back().size() > 1; ++level)
+	{
+		const auto& children = levels_.back();
+		std::vector<std::uint64_t> parents((children.size() + 1) / 2);
+		for (std::size_t i = 0; i < parents.size(); ++i)
+		{
+			auto count = std::min<std::size_t>(2, children.size() - 2 * i);
+			parents[i] = xxh64(reinterpret_cast<const std::byte*>(children.data() + 2 * i), count * sizeof(std::uint64_t), level);
+		}
+		levels_.push_back(std::move(parents));
+	}
+}
+
+template<class S>
+block_tree block_tree::build(const S& seq, base_range trimmed, std::size_t block_bytes)
+{
+	block_bytes = std::max<std::size_t>(block_bytes, 1);
+	const auto* data = reinterpret_cast<const std::byte*>(std::data(seq.buffer()));
+	auto begin = trimmed.first / packed_size::value;
+	auto end = std::max(begin, (trimmed.last + packed_size::value - 1) / packed_size::value);
+
+	std::vector<std::uint64_t> leaves;
+	leaves.reserve((end - begin + block_bytes - 1) / block_bytes);
+	for (auto offset = begin; offset < end; offset += block_bytes)
+		leaves.push_back(xxh64(data + offset, std::min(block_bytes, end - offset)));
+	return block_tree(trimmed.first, block_bytes, end - begin, std::move(leaves));
+}
+
+/*
+ * Bases where two chromosomes may differ, given trees built with the same
+ * block size and phase, as ranges relative to each one's first real base.
+ * Subtrees whose hashes are equal are skipped without looking at their
+ * leaves. Everything beyond the shorter tree counts as different.
+ */
+inline std::vector<base_range> differing_ranges(const block_tree& a, const block_tree& b)
+{
+	if (a.block_bytes() != b.block_bytes() || a.phase() != b.phase())
+		throw std::invalid_argument("block trees are not comparable");
+
+	auto leaves = std::max(a.leaves().size(), b.leaves().size());
+	auto block_bases = a.block_bytes() * packed_size::value;
+	auto phase = a.phase();
+	std::vector<base_range> ranges;
+
+	auto add = [&](std::size_t first_leaf, std::size_t last_leaf) {
+		auto first = first_leaf * block_bases;
+		auto last = std::min(last_leaf, leaves) * block_bases;
+		first = first > phase ? first - phase : 0;
+		last -= phase;
+		if (!ranges.empty() && ranges.back().last >= first)
+			ranges.back().last = std::max(ranges.back().last, last);
+		else
+			ranges.push_back({ first, last });
+	};
+
+	auto exists = [](const block_tree& tree, std::size_t level, std::size_t index) {
+		return level < tree.height() && index < tree.level(level).size();
+	};
+
+	// depth first from the top level, left to right, so ranges come out sorted
+	auto top = std::max(a.height(), b.height()) - 1;
+	auto visit = [&](auto& self, std::size_t level, std::size_t index) -> void {
+		auto first_leaf = index << level;
+		if (first_leaf >= leaves)
+			return;
+		bool in_a = exists(a, level, index);
+		bool in_b = exists(b, level, index);
+		if (in_a && in_b && a.level(level)[index] == b.level(level)[index])
+			return;
+		if (level == 0 || first_leaf >= std::min(a.leaves().size(), b.leaves().size()))
+		{
+			add(first_leaf, (index + 1) << level);
+			return;
+		}
+		self(self, level - 1, 2 * index);
+		self(self, level - 1, 2 * index + 1);
+	};
+	if (leaves != 0)
+		visit(visit, top, 0);
+	return ranges;
+}
+
+using fingerprint_table = std::array<block_tree, 23>;
+
+/*
+ * On-disk block hashes of one person, written next to the sample so later
+ * comparisons skip identical regions without hashing them again.
+ *
+ * All integers are little endian.
+ *   header  8 bytes "DNAHASH1", uint32 version, uint32 chromosome count,
+ *           uint64 block size in bytes
+ *   then per chromosome: uint64 size in bases, uint64 first real base,
+ *     uint64 bytes hashed, uint64 leaf count, and that many uint64 leaf hashes
+ * Parent hashes are rebuilt from the leaves when the file is read.
+ */
+namespace fingerprint_index
+{
+
+constexpr char magic[8] = { 'D', 'N', 'A', 'H', 'A', 'S', 'H', '1' };
+constexpr std::uint32_t version = 1;
+constexpr std::size_t header_size = 24;
+
+namespace detail
+{
+
+using trim_index::detail::get_u32;
+using trim_index::detail::put_u32;
+
+inline void put_u64(std::vector<std::byte>& out, std::uint64_t value)
+{
+	for (std::size_t i = 0; i < 8; ++i)
+		out.push_back(static_cast<std::byte>(value >> (8 * i)));
+}
+
+inline std::uint64_t get_u64(const std::byte* in)
+{
+	return get_u32(in) | (std::uint64_t{ get_u32(in + 4) } << 32);
+}
+
+}
+
+template<std::size_t N>
+std::vector<std::byte> encode(const std::array<block_tree, N>& table, const std::array<std::size_t, N>& sizes)
+{
+	std::vector<std::byte> out(16);
+	for (std::size_t i = 0; i < sizeof(magic); ++i)
+		out[i] = static_cast<std::byte>(magic[i]);
+	detail::put_u32(out.data() + 8, version);
+	detail::put_u32(out.data() + 12, static_cast<std::uint32_t>(N));
+	detail::put_u64(out, N == 0 ? 0 : table[0].block_bytes());
+
+	for (std::size_t i = 0; i < N; ++i)
+	{
+		detail::put_u64(out, sizes[i]);
+		detail::put_u64(out, table[i].first_base());
+		detail::put_u64(out, table[i].bytes());
+		detail::put_u64(out, table[i].leaves().size());
+		for (auto hash : table[i].leaves())
+			detail::put_u64(out, hash);
+	}
+	return out;
+}
+
+/*
+ * Decodes an index and checks it against the chromosome sizes of the person it
+ * is loaded for. Throws std::runtime_error for anything that doesn't match.
+ */
+template<std::size_t N>
+std::array<block_tree, N> decode(const std::byte* data, std::size_t size, const std::array<std::size_t, N>& sizes)
+{
+	if (size < header_size)
+		throw std::runtime_error("fingerprint index is too short");
+	for (std::size_t i = 0; i < sizeof(magic); ++i)
+	{
+		if (data[i] != static_cast<std::byte>(magic[i]))
+			throw std::runtime_error("not a fingerprint index");
+	}
+	if (detail::get_u32(data + 8) != version || detail::get_u32(data + 12) != N)
+		throw std::runtime_error("unsupported fingerprint index version");
+	auto block_bytes = static_cast<std::size_t>(detail::get_u64(data + 16));
+
+	std::array<block_tree, N> table;
+	std::size_t at = header_size;
+	for (std::size_t i = 0; i < N; ++i)
+	{
+		if (size - at < 32)
+			throw std::runtime_error("fingerprint index is too short");
+		if (detail::get_u64(data + at) != sizes[i])
+			throw std::runtime_error("fingerprint index does not belong to this sample");
+		auto first = static_cast<std::size_t>(detail::get_u64(data + at + 8));
+		auto bytes = static_cast<std::size_t>(detail::get_u64(data + at + 16));
+		auto count = static_cast<std::size_t>(detail::get_u64(data + at + 24));
+		at += 32;
+		if (first > sizes[i] || bytes > sizes[i] / packed_size::value - first / packed_size::value)
+			throw std::runtime_error("fingerprint index hashes bases past the chromosome");
+		if (count > (size - at) / 8)
+			throw std::runtime_error("fingerprint index is too short");
+
+		std::vector<std::uint64_t> leaves(count);
+		for (auto& hash : leaves)
+		{
+			hash = detail::get_u64(data + at);
+			at += 8;
+		}
+		try
+		{
+			table[i] = block_tree(first, block_bytes, bytes, std::move(leaves));
+		}
+		catch (const std::invalid_argument& e)
+		{
+			throw std::runtime_error(std::string("fingerprint index is damaged: ") + e.what());
+		}
+	}
+	if (at != size)
+		throw std::runtime_error("fingerprint index has the wrong size");
+	return table;
+}
+
+template<std::size_t N>
+void write(const std::filesystem::path& path, const std::array<block_tree, N>& table, const std::array<std::size_t, N>& sizes)
+{
+	auto bytes = encode(table, sizes);
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!out)
+		throw std::runtime_error("unable to write " + path.string());
+}
+
+template<std::size_t N>
+std::array<block_tree, N> read(const std::filesystem::path& path, const std::array<std::size_t, N>& sizes)
+{
+	mapped_file file(path);
+	return decode(file.data(), file.size(), sizes);
+}
+
+}
+
+}
@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "synthetic_genome.hpp"
+
+/*
+ * Writes a seeded synthetic person and mutated relatives of them:
+ *
+ *   OUT/base/chr01.bin ... chr23.bin
+ *   OUT/relative_01/...
+ *   OUT/summary.tsv       what was generated, one line per chromosome
+ *
+ * Each directory can be passed to dna::Person as is. Chromosomes are generated
+ * one at a time for every person, so memory stays at a few copies of the
+ * largest chromosome even at full scale.
+ */
+
+namespace
+{
+
+struct options
+{
+	std::filesystem::path out = "synthetic";
+	double scale = 1.0;
+	bool male = false;
+	std::uint64_t seed = 1;
+	std::size_t relatives = 0;
+	dna::synthetic::mutation_rates person{};
+	dna::synthetic::mutation_rates relative{ 0.0001, 0.00001, 20 };
+	dna::synthetic::telomere_options telomeres{};
+};
+
+void usage()
+{
+	std::fprintf(stderr,
+			"usage: dna_gen [options]\n"
+			"  --out DIR                   output directory (synthetic)\n"
+			"  --scale F                   fraction of the real chromosome lengths (1.0)\n"
+			"  --sex x|y                   second sex chromosome (x)\n"
+			"  --seed N                    random seed (1)\n"
+			"  --snp-rate F                base person's SNPs per base (0.001)\n"
+			"  --indel-rate F              base person's indels per base (0.0001)\n"
+			"  --max-indel N               longest indel in bases (20)\n"
+			"  --telomere-repeats N        mean TTAGGG repeats per end (1800)\n"
+			"  --telomere-jitter N         repeats vary by up to this many (600)\n"
+			"  --lost-telomere-rate F      chance an end has no telomere (0)\n"
+			"  --relatives N               relatives of the base person to write (0)\n"
+			"  --relative-snp-rate F       relatives' extra SNPs per base (0.0001)\n"
+			"  --relative-indel-rate F     relatives' extra indels per base (0.00001)\n");
+}
+
+options parse(int argc, char** argv)
+{
+	options result;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view flag = argv[i];
+		if (flag == "--help" || flag == "-h")
+		{
+			usage();
+			std::exit(0);
+		}
+		if (i + 1 == argc)
+			throw std::invalid_argument("missing value for " + std::string(flag));
+		std::string value = argv[++i];
+
+		if (flag == "--out")
+			result.out = value;
+		else if (flag == "--scale")
+			result.scale = std::stod(value);
+		else if (flag == "--sex")
+		{
+			if (value != "x" && value != "y")
+				throw std::invalid_argument("--sex must be x or y");
+			result.male = value == "y";
+		}
+		else if (flag == "--seed")
+			result.seed = std::stoull(value);
+		else if (flag == "--snp-rate")
+			result.person.snp = std::stod(value);
+		else if (flag == "--indel-rate")
+			result.person.indel = std::stod(value);
+		else if (flag == "--max-indel")
+			result.person.max_indel = result.relative.max_indel = std::stoull(value);
+		else if (flag == "--telomere-repeats")
+			result.telomeres.mean_repeats = std::stoull(value);
+		else if (flag == "--telomere-jitter")
+			result.telomeres.jitter = std::stoull(value);
+		else if (flag == "--lost-telomere-rate")
+			result.telomeres.lost_rate = std::stod(value);
+		else if (flag == "--relatives")
+			result.relatives = std::stoull(value);
+		else if (flag == "--relative-snp-rate")
+			result.relative.snp = std::stod(value);
+		else if (flag == "--relative-indel-rate")
+			result.relative.indel = std::stod(value);
+		else
+			throw std::invalid_argument("unknown option " + std::string(flag));
+	}
+	if (result.scale <= 0 || result.scale > 1)
+		throw std::invalid_argument("--scale must be in (0, 1]");
+	return result;
+}
+
+std::string person_name(std::size_t person)
+{
+	if (person == 0)
+		return "base";
+	char name[32];
+	std::snprintf(name, sizeof(name), "relative_%02zu", person);
+	return name;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	using namespace dna::synthetic;
+
+	try
+	{
+		auto opts = parse(argc, argv);
+		auto people = opts.relatives + 1;
+		for (std::size_t person = 0; person < people; ++person)
+			std::filesystem::create_directories(opts.out / person_name(person));
+
+		std::ofstream summary(opts.out / "summary.tsv", std::ios::trunc);
+		summary << "person\tchromosome\tbases\thead_repeats\thead_partial\ttail_repeats\ttail_partial"
+				"\tlost_head_bases\tlost_tail_bases\tsnps\tindels\n";
+
+		std::size_t total = 0;
+		for (std::size_t chromosome = 0; chromosome < 23; ++chromosome)
+		{
+			// the reference is only needed until the base person is derived from it
+			chromosome_summary base_changes;
+			auto base = mutate(
+					random_body(scaled_bases(chromosome, opts.scale, opts.male), derive_seed(opts.seed, 0, chromosome, 0)),
+					opts.person, derive_seed(opts.seed, 0, chromosome, 1), &base_changes);
+
+			for (std::size_t person = 0; person < people; ++person)
+			{
+				auto changes = base_changes;
+				auto data = person == 0
+						? add_telomeres(base, opts.telomeres, derive_seed(opts.seed, 0, chromosome, 2), &changes)
+						: add_telomeres(mutate(base, opts.relative, derive_seed(opts.seed, person, chromosome, 1), &changes),
+								opts.telomeres, derive_seed(opts.seed, person, chromosome, 2), &changes);
+				write_chromosome(opts.out / person_name(person), chromosome, data);
+				total += data.size();
+
+				summary << person_name(person) << '\t' << chromosome + 1 << '\t' << changes.bases << '\t'
+						<< changes.head_repeats << '\t' << changes.head_partial << '\t'
+						<< changes.tail_repeats << '\t' << changes.tail_partial << '\t'
+						<< changes.lost_head_bases << '\t' << changes.lost_tail_bases << '\t'
+						<< changes.snps << '\t' << changes.indels << '\n';
+			}
+			std::fprintf(stderr, "chromosome %zu done\n", chromosome + 1);
+		}
+		if (!summary)
+			throw std::runtime_error("unable to write summary.tsv");
+		std::fprintf(stderr, "wrote %zu people, %.1f MB\n", people, static_cast<double>(total) / 1e6);
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "dna_gen: %s\n", e.what());
+		usage();
+		return 1;
+	}
+	return 0;
+}
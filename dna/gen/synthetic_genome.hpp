@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "sequence_buffer.hpp"
+#include "telomere.hpp"
+
+namespace dna
+{
+
+/*
+ * Seeded synthetic people for tests and benchmarks at real genome scale.
+ *
+ * A reference body is random bases per chromosome. A person is the reference
+ * with SNPs and indels applied, wrapped in telomeres of a random length that
+ * the sequencer cut into at both outer ends; some ends lose every repeat and
+ * a few real bases as well. Relatives apply a few more mutations to a
+ * person's bodies and get telomeres of their own. The same seed always gives
+ * the same bases.
+ */
+namespace synthetic
+{
+
+/*
+ * GRCh38 lengths of chromosomes 1-22, X and Y.
+ */
+constexpr std::array<std::size_t, 24> chromosome_bases = {
+	248'956'422, 242'193'529, 198'295'559, 190'214'555, 181'538'259, 170'805'979,
+	159'345'973, 145'138'636, 138'394'717, 133'797'422, 135'086'622, 133'275'309,
+	114'364'328, 107'043'718, 101'991'189, 90'338'345, 83'257'441, 80'373'285,
+	58'617'616, 64'444'167, 46'709'983, 50'818'468,
+	156'040'895, 57'227'415
+};
+
+constexpr std::size_t x_index = 22;
+constexpr std::size_t y_index = 23;
+
+struct mutation_rates
+{
+	// chance per base of a substitution, and of an insertion or deletion
+	double snp = 0.001;
+	double indel = 0.0001;
+	std::size_t max_indel = 20;
+};
+
+struct telomere_options
+{
+	// complete repeats per end: mean +- jitter, uniformly
+	std::size_t mean_repeats = 1800;
+	std::size_t jitter = 600;
+	// chance an end lost every repeat, and up to how many real bases went with them
+	double lost_rate = 0.0;
+	std::size_t max_lost_bases = 100;
+};
+
+/*
+ * What was generated for one chromosome, so benchmarks can check results.
+ */
+struct chromosome_summary
+{
+	std::size_t bases = 0;
+	std::size_t head_repeats = 0;
+	std::size_t head_partial = 0;
+	std::size_t tail_repeats = 0;
+	std::size_t tail_partial = 0;
+	std::size_t lost_head_bases = 0;
+	std::size_t lost_tail_bases = 0;
+	std::size_t snps = 0;
+	std::size_t indels = 0;
+};
+
+using body = sequence_buffer<std::vector<std::byte>>;
+
+/*
+ * Appends bases to packed bytes, a word at a time where it can.
+ */
+class packed_writer
+{
+	std::vector<std::byte> bytes_;
+	std::uint64_t pending_ = 0;
+	std::size_t pending_bases_ = 0;
+	std::size_t size_ = 0;
+public:
+	explicit packed_writer(std::size_t reserve_bases = 0)
+	{
+		bytes_.reserve(reserve_bases / packed_size::value + sizeof(packed_word));
+	}
+
+	void put(base value)
+	{
+		pending_ = (pending_ << 2) | static_cast<std::uint64_t>(value);
+		++size_;
+		if (++pending_bases_ == packed_size::value)
+		{
+			bytes_.push_back(static_cast<std::byte>(pending_));
+			pending_ = 0;
+			pending_bases_ = 0;
+		}
+	}
+
+	/*
+	 * The first `count` bases of a packed word.
+	 */
+	void put_word(packed_word word, std::size_t count)
+	{
+		std::size_t i = 0;
+		for (; i < count && pending_bases_ != 0; ++i)
+			put(static_cast<base>((word >> (62 - 2 * i)) & 3));
+		for (; i + packed_size::value <= count; i += packed_size::value)
+		{
+			bytes_.push_back(static_cast<std::byte>(word >> (56 - 2 * i)));
+			size_ += packed_size::value;
+		}
+		for (; i < count; ++i)
+			put(static_cast<base>((word >> (62 - 2 * i)) & 3));
+	}
+
+	template<class S>
+	void put_range(const S& seq, std::size_t first, std::size_t last)
+	{
+		for (auto at = first; at < last; at += word_bases)
+			put_word(seq.word_at(at), std::min(word_bases, last - at));
+	}
+
+	std::size_t size() const noexcept
+	{
+		return size_;
+	}
+
+	/*
+	 * The bases written so far; a partial last byte is padded with A.
+	 */
+	body finish()
+	{
+		auto size = size_;
+		while (pending_bases_ != 0)
+		{
+			put(A);
+			--size_;
+		}
+		return body(std::move(bytes_), size);
+	}
+};
+
+/*
+ * `count` random bases that start and end with C, so they never extend a telomere.
+ */
+inline body random_body(std::size_t count, std::uint64_t seed)
+{
+	std::mt19937_64 rng(seed);
+	packed_writer out(count);
+	for (std::size_t i = 0; i < count; i += word_bases)
+		out.put_word(rng(), std::min(word_bases, count - i));
+	auto result = out.finish();
+
+	auto set = [&](std::size_t index) {
+		auto shift = 6 - 2 * (index % packed_size::value);
+		auto& b = result.buffer()[index / packed_size::value];
+		b = (b & ~(std::byte{0x3} << shift)) | (static_cast<std::byte>(C) << shift);
+	};
+	if (count != 0)
+	{
+		set(0);
+		set(count - 1);
+	}
+	return result;
+}
+
+/*
+ * A copy of `source` with SNPs and indels at the given rates. The first and
+ * last base are never touched.
+ */
+inline body mutate(const body& source, const mutation_rates& rates, std::uint64_t seed, chromosome_summary* summary = nullptr)
+{
+	auto total = rates.snp + rates.indel;
+	if (total <= 0 || source.size() < 2)
+		return body(source.buffer(), source.size());
+
+	std::mt19937_64 rng(seed);
+	std::geometric_distribution<std::size_t> gap(std::min(total, 1.0));
+	std::bernoulli_distribution is_snp(rates.snp / total);
+	std::uniform_int_distribution<std::size_t> indel_length(1, std::max<std::size_t>(rates.max_indel, 1));
+
+	packed_writer out(source.size() + source.size() / 64);
+	std::size_t at = 1;
+	out.put(source[0]);
+	while (true)
+	{
+		auto event = at + gap(rng);
+		if (event >= source.size() - 1)
+			break;
+
+		out.put_range(source, at, event);
+		if (is_snp(rng))
+		{
+			out.put(static_cast<base>((static_cast<unsigned>(source[event]) + 1 + rng() % 3) % 4));
+			at = event + 1;
+			if (summary != nullptr)
+				++summary->snps;
+			continue;
+		}
+
+		auto length = indel_length(rng);
+		if (rng() & 1)
+		{
+			for (std::size_t i = 0; i < length; ++i)
+				out.put(static_cast<base>(rng() & 3));
+			at = event;
+		}
+		else
+		{
+			out.put(source[event]);
+			at = std::min(event + 1 + length, source.size() - 1);
+		}
+		if (summary != nullptr)
+			++summary->indels;
+	}
+	out.put_range(source, at, source.size());
+	return out.finish();
+}
+
+/*
+ * Wraps a body in telomeres and packs it into whole bytes: the head starts
+ * with the last bases of a cut repeat, the tail ends with the first bases of
+ * one, and the tail's cut is chosen so the chromosome fills its last byte.
+ * An end that lost its telomere has no repeats, loses some real bases, and
+ * gives up up to 3 more at the tail to fill the last byte.
+ */
+inline std::vector<std::byte> add_telomeres(const body& source, const telomere_options& options, std::uint64_t seed,
+		chromosome_summary* summary = nullptr)
+{
+	std::mt19937_64 rng(seed);
+	std::bernoulli_distribution lost(options.lost_rate);
+	std::uniform_int_distribution<std::size_t> repeats(
+			options.mean_repeats - std::min(options.jitter, options.mean_repeats), options.mean_repeats + options.jitter);
+	std::uniform_int_distribution<std::size_t> lost_bases(0, std::min(options.max_lost_bases, source.size() / 4));
+
+	chromosome_summary ends;
+	std::size_t first = 0;
+	std::size_t last = source.size();
+	if (lost(rng))
+	{
+		ends.lost_head_bases = lost_bases(rng);
+		first = ends.lost_head_bases;
+	}
+	else
+	{
+		ends.head_repeats = repeats(rng);
+		ends.head_partial = rng() % detail::telomere_period;
+	}
+
+	bool tail_lost = lost(rng);
+	if (tail_lost)
+	{
+		ends.lost_tail_bases = lost_bases(rng);
+		last -= ends.lost_tail_bases;
+	}
+	else
+	{
+		ends.tail_repeats = repeats(rng);
+	}
+
+	auto head = ends.head_partial + ends.head_repeats * detail::telomere_period;
+	if (tail_lost)
+	{
+		auto extra = (head + last - first) % packed_size::value;
+		last -= extra;
+		ends.lost_tail_bases += extra;
+	}
+	else
+	{
+		// a cut 0..5 bases into the repeat; two of every four fit, pick one of them
+		std::vector<std::size_t> fits;
+		for (std::size_t partial = 0; partial < detail::telomere_period; ++partial)
+		{
+			if ((head + last - first + ends.tail_repeats * detail::telomere_period + partial) % packed_size::value == 0)
+				fits.push_back(partial);
+		}
+		ends.tail_partial = fits[rng() % fits.size()];
+	}
+
+	packed_writer out(head + source.size() + (ends.tail_repeats + 1) * detail::telomere_period);
+	for (auto i = detail::telomere_period - ends.head_partial; i < detail::telomere_period; ++i)
+		out.put(telo[i]);
+	for (std::size_t r = 0; r < ends.head_repeats; ++r)
+		for (auto b : telo)
+			out.put(b);
+	out.put_range(source, first, last);
+	for (std::size_t r = 0; r < ends.tail_repeats; ++r)
+		for (auto b : telo)
+			out.put(b);
+	for (std::size_t i = 0; i < ends.tail_partial; ++i)
+		out.put(telo[i]);
+
+	if (summary != nullptr)
+	{
+		ends.snps = summary->snps;
+		ends.indels = summary->indels;
+		ends.bases = out.size();
+		*summary = ends;
+	}
+	return out.finish().buffer();
+}
+
+/*
+ * Length of chromosome `index` (0..22) at `scale`, a Y for chromosome 23 of a male.
+ */
+inline std::size_t scaled_bases(std::size_t index, double scale, bool male)
+{
+	auto real = chromosome_bases[index == x_index && male ? y_index : index];
+	return std::max<std::size_t>(static_cast<std::size_t>(static_cast<double>(real) * scale), 64);
+}
+
+/*
+ * An independent seed for each person, chromosome and use of randomness
+ * derived from one run seed (splitmix64), so any part can be regenerated alone.
+ */
+inline std::uint64_t derive_seed(std::uint64_t seed, std::size_t person, std::size_t chromosome, std::size_t use)
+{
+	auto z = seed + 0x9e3779b97f4a7c15ull * (1 + ((person * 64 + chromosome) * 4 + use));
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+/*
+ * chr01.bin ... chr23.bin in `dir`, the layout write_chromosome() produces.
+ */
+inline std::array<std::filesystem::path, 23> chromosome_paths(const std::filesystem::path& dir)
+{
+	std::array<std::filesystem::path, 23> paths;
+	for (std::size_t i = 0; i < paths.size(); ++i)
+	{
+		char name[16];
+		std::snprintf(name, sizeof(name), "chr%02zu.bin", i + 1);
+		paths[i] = dir / name;
+	}
+	return paths;
+}
+
+inline void write_chromosome(const std::filesystem::path& dir, std::size_t index, const std::vector<std::byte>& data)
+{
+	auto path = chromosome_paths(dir)[index];
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	if (!out)
+		throw std::runtime_error("unable to write " + path.string());
+}
+
+}
+
+}
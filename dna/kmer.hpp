@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "base.hpp"
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+/*
+ * Up to 32 packed bases, first base in the high bits of the k used.
+ */
+using kmer = std::uint64_t;
+
+/*
+ * The k bases starting at `index`, or zero past the end of the sequence.
+ */
+template<class S>
+kmer kmer_at(const S& seq, std::size_t index, std::size_t k)
+{
+	return seq.word_at(index) >> (2 * (word_bases - k));
+}
+
+/*
+ * Every `step`th k-mer of a sequence, sorted so a k-mer's positions can be
+ * looked up by binary search. Positions are relative to the indexed range.
+ */
+class kmer_index
+{
+public:
+	struct entry
+	{
+		kmer value;
+		std::uint32_t position;
+
+		constexpr bool operator<(const entry& other) const noexcept
+		{
+			return value < other.value || (value == other.value && position < other.position);
+		}
+	};
+
+private:
+	std::size_t k_;
+	std::size_t step_;
+	std::size_t length_;
+	std::vector<entry> entries_;
+
+public:
+	/*
+	 * Indexes the k-mers that start at first, first + step, ... and end by `last`.
+	 */
+	template<class S>
+	kmer_index(const S& seq, std::size_t first, std::size_t last, std::size_t k, std::size_t step = 1);
+
+	std::span<const entry> find(kmer value) const noexcept
+	{
+		auto range = std::equal_range(entries_.begin(), entries_.end(), entry{ value, 0 },
+				[](const entry& x, const entry& y) { return x.value < y.value; });
+		return { range.first, range.second };
+	}
+
+	constexpr std::size_t k() const noexcept
+	{
+		return k_;
+	}
+
+	constexpr std::size_t step() const noexcept
+	{
+		return step_;
+	}
+
+	/*
+	 * Number of bases in the indexed range.
+	 */
+	constexpr std::size_t length() const noexcept
+	{
+		return length_;
+	}
+
+	std::size_t size() const noexcept
+	{
+		return entries_.size();
+	}
+};
+
+template<class S>
+kmer_index::kmer_index(const S& seq, std::size_t first, std::size_t last, std::size_t k, std::size_t step) :
+		k_(k),
+		step_(std::max<std::size_t>(step, 1)),
+		length_(last > first ? last - first : 0),
+		entries_()
+{
+	if (k == 0 || k > word_bases)
+		throw std::invalid_argument("k-mers must have between 1 and 32 bases");
+
+	if (length_ >= k)
+	{
+		entries_.reserve((length_ - k) / step_ + 1);
+		for (std::size_t i = 0; i + k <= length_; i += step_)
+			entries_.push_back({ kmer_at(seq, first + i, k), static_cast<std::uint32_t>(i) });
+	}
+	std::sort(entries_.begin(), entries_.end());
+}
+
+/*
+ * Slides a k-mer over [first, last) of `seq` and counts, for every diagonal
+ * (position in seq minus position in the index), how many k-mers agree.
+ * Returns the diagonal with most votes and its count; k-mers that occur more
+ * than `max_hits` times in the index are repeats and don't vote. With a
+ * `stride` above one only every stride-th position of seq is looked up, so
+ * a diagonal gets about 1/stride of the votes for as many fewer lookups.
+ */
+template<class S>
+std::pair<long, std::size_t> best_diagonal(const kmer_index& index, const S& seq, std::size_t first, std::size_t last,
+		std::size_t max_hits = 8, std::size_t stride = 1)
+{
+	std::vector<long> diagonals;
+	for (auto p = first; p + index.k() <= last; p += stride)
+	{
+		auto hits = index.find(kmer_at(seq, p, index.k()));
+		if (hits.size() > max_hits)
+			continue;
+		for (const auto& hit : hits)
+			diagonals.push_back(static_cast<long>(p) - static_cast<long>(hit.position));
+	}
+
+	std::sort(diagonals.begin(), diagonals.end());
+	std::pair<long, std::size_t> best{ 0, 0 };
+	for (std::size_t i = 0; i < diagonals.size();)
+	{
+		auto j = i;
+		while (j < diagonals.size() && diagonals[j] == diagonals[i])
+			++j;
+		if (j - i > best.second)
+			best = { diagonals[i], j - i };
+		i = j;
+	}
+	return best;
+}
+
+/*
+ * How many of the indexed k-mers are found again in `seq` on one diagonal,
+ * i.e. the k-mer indexed at position i also starts at seq[i + diagonal].
+ */
+template<class S>
+std::size_t diagonal_votes(const kmer_index& index, const S& seq, long diagonal)
+{
+	std::size_t votes = 0;
+	for (std::size_t i = 0; i + index.k() <= index.length(); i += index.step())
+	{
+		auto p = diagonal + static_cast<long>(i);
+		if (p < 0 || static_cast<std::size_t>(p) + index.k() > seq.size())
+			continue;
+		auto hits = index.find(kmer_at(seq, static_cast<std::size_t>(p), index.k()));
+		votes += std::any_of(hits.begin(), hits.end(), [&](const kmer_index::entry& hit) { return hit.position == i; });
+	}
+	return votes;
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace dna
+{
+
+/*
+ * A value that is computed on first use and then kept. Copying the owner
+ * shares a value that is already there; a copy made before it is computed
+ * computes its own. Once set it never changes, so references handed out stay
+ * valid until the owner is destroyed or assigned to.
+ *
+ * The value is computed outside the lock: a computation may run tasks on a
+ * pool that ask for the same value, and blocking them would deadlock. If two
+ * threads race, both compute and the first result is kept.
+ */
+template<class T>
+class lazy_value
+{
+	mutable std::mutex mutex_;
+	mutable std::shared_ptr<const T> value_;
+public:
+	lazy_value() = default;
+
+	lazy_value(const lazy_value& other) :
+			value_(other.load())
+	{ }
+
+	lazy_value& operator=(const lazy_value& other)
+	{
+		auto value = other.load();
+		std::lock_guard<std::mutex> lock(mutex_);
+		value_ = std::move(value);
+		return *this;
+	}
+
+	std::shared_ptr<const T> load() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return value_;
+	}
+
+	/*
+	 * Stores `value` unless there already is one, and returns the stored value.
+	 */
+	const T& set(T value) const
+	{
+		auto computed = std::make_shared<const T>(std::move(value));
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!value_)
+			value_ = std::move(computed);
+		return *value_;
+	}
+
+	template<class F>
+	const T& get(F&& compute) const
+	{
+		if (auto value = load())
+			return *value;
+		return set(compute());
+	}
+};
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dna
+{
+
+enum class access_pattern
+{
+	normal,
+	sequential,
+	random
+};
+
+/*
+ * Read-only memory mapping of a whole file. The pages are shared with the
+ * page cache, so every process that maps the same file shares one copy.
+ */
+class mapped_file
+{
+	const std::byte* data_;
+	std::size_t size_;
+public:
+	explicit mapped_file(const std::filesystem::path& path);
+	mapped_file(const mapped_file&) = delete;
+	mapped_file(mapped_file&& other) noexcept;
+	~mapped_file();
+
+	mapped_file& operator=(const mapped_file&) = delete;
+	mapped_file& operator=(mapped_file&& other) noexcept;
+
+	const std::byte* data() const noexcept
+	{
+		return data_;
+	}
+
+	std::size_t size() const noexcept
+	{
+		return size_;
+	}
+
+	/*
+	 * Tell the kernel how [offset, offset + length) is about to be read.
+	 * Advice is only a hint, so failures are ignored.
+	 */
+	void advise(access_pattern pattern, std::size_t offset = 0, std::size_t length = static_cast<std::size_t>(-1)) const noexcept;
+};
+
+inline mapped_file::mapped_file(const std::filesystem::path& path) :
+		data_(nullptr),
+		size_(0)
+{
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw std::system_error(errno, std::generic_category(), "unable to open " + path.string());
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0)
+	{
+		int error = errno;
+		::close(fd);
+		throw std::system_error(error, std::generic_category(), "unable to stat " + path.string());
+	}
+
+	size_ = static_cast<std::size_t>(st.st_size);
+	if (size_ != 0)
+	{
+		void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED)
+		{
+			int error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), "unable to map " + path.string());
+		}
+		data_ = static_cast<const std::byte*>(addr);
+	}
+
+	// the mapping keeps the file referenced
+	::close(fd);
+}
+
+inline mapped_file::mapped_file(mapped_file&& other) noexcept :
+		data_(other.data_),
+		size_(other.size_)
+{
+	other.data_ = nullptr;
+	other.size_ = 0;
+}
+
+inline mapped_file::~mapped_file()
+{
+	if (data_ != nullptr)
+		::munmap(const_cast<std::byte*>(data_), size_);
+}
+
+inline mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (data_ != nullptr)
+			::munmap(const_cast<std::byte*>(data_), size_);
+		data_ = other.data_;
+		size_ = other.size_;
+		other.data_ = nullptr;
+		other.size_ = 0;
+	}
+	return *this;
+}
+
+inline void mapped_file::advise(access_pattern pattern, std::size_t offset, std::size_t length) const noexcept
+{
+	if (data_ == nullptr || offset >= size_)
+		return;
+
+	// madvise wants a page aligned start
+	auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	auto start = offset / page * page;
+	auto end = length > size_ - offset ? size_ : offset + length;
+
+	int advice = MADV_NORMAL;
+	if (pattern == access_pattern::sequential)
+		advice = MADV_SEQUENTIAL;
+	else if (pattern == access_pattern::random)
+		advice = MADV_RANDOM;
+
+	::madvise(const_cast<std::byte*>(data_) + start, end - start, advice);
+}
+
+}
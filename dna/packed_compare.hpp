@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+namespace detail
+{
+
+/*
+ * Collapses the XOR of two packed words to one bit per base: the high bit of
+ * every base that differs.
+ */
+constexpr packed_word differing_bases(packed_word diff)
+{
+	return (diff | (diff << 1)) & 0xaaaaaaaaaaaaaaaaull;
+}
+
+/*
+ * The high bit of every base that is the same in both words of an XOR.
+ */
+constexpr packed_word equal_bases(packed_word diff)
+{
+	auto same = ~diff;
+	return same & (same << 1) & 0xaaaaaaaaaaaaaaaaull;
+}
+
+/*
+ * Base offset of seq.data() within the packed storage; non-zero only for
+ * views that start inside a byte.
+ */
+template<class S>
+constexpr std::size_t packed_origin(const S& seq) noexcept
+{
+	if constexpr (requires { seq.first_base(); })
+		return seq.first_base();
+	else
+		return 0;
+}
+
+/*
+ * Offset (0..31) of the first base set in a differing_bases() word.
+ */
+inline std::size_t first_base(packed_word bits)
+{
+	return static_cast<std::size_t>(__builtin_clzll(bits)) / 2;
+}
+
+/*
+ * Number of whole bytes at the start of a and b that are identical, looking at
+ * no more than `count`. Identical regions cost one XOR per 8 bytes (32 bases),
+ * or one compare per 32 bytes with AVX2.
+ */
+inline std::size_t equal_bytes(const std::byte* a, const std::byte* b, std::size_t count)
+{
+	std::size_t i = 0;
+#if defined(__AVX2__)
+	for (; i + 32 <= count; i += 32)
+	{
+		auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != -1)
+			break;
+	}
+#endif
+	for (; i + sizeof(packed_word) <= count; i += sizeof(packed_word))
+	{
+		packed_word wa, wb;
+		std::memcpy(&wa, a + i, sizeof(wa));
+		std::memcpy(&wb, b + i, sizeof(wb));
+		if (wa != wb)
+			break;
+	}
+	for (; i < count && a[i] == b[i]; ++i)
+		;
+	return i;
+}
+
+}
+
+/*
+ * First offset k in [0, length) where a[ia + k] != b[ib + k], or `length`.
+ * When ia and ib sit at the same position within a byte of their storage
+ * (see detail::packed_origin()) the packed bytes are compared directly;
+ * otherwise each side is read as funnel shifted words
+ * (see load_packed_word()), so a misaligned pair still costs one XOR per 32
+ * bases. Both ranges must lie within their sequences.
+ */
+template<class A, class B>
+std::size_t find_mismatch(const A& a, std::size_t ia, const B& b, std::size_t ib, std::size_t length)
+{
+	std::size_t k = 0;
+	auto oa = ia + detail::packed_origin(a);
+	auto ob = ib + detail::packed_origin(b);
+	bool aligned = oa % packed_size::value == ob % packed_size::value;
+
+	if (aligned && oa % packed_size::value != 0 && length != 0)
+	{
+		auto bits = detail::differing_bases((a.word_at(ia) ^ b.word_at(ib)) & word_mask(length));
+		if (bits != 0)
+			return detail::first_base(bits);
+		k = (oa + word_bases) / packed_size::value * packed_size::value - oa;
+	}
+
+	while (k < length)
+	{
+		if (aligned)
+		{
+			auto bytes = (length - k) / packed_size::value;
+			k += detail::equal_bytes(
+					a.data() + (oa + k) / packed_size::value,
+					b.data() + (ob + k) / packed_size::value,
+					bytes) * packed_size::value;
+			if (k >= length)
+				break;
+		}
+
+		auto bits = detail::differing_bases((a.word_at(ia + k) ^ b.word_at(ib + k)) & word_mask(length - k));
+		if (bits != 0)
+			return k + detail::first_base(bits);
+		k += word_bases;
+	}
+	return std::min(k, length);
+}
+
+/*
+ * First offset k in [0, length) where a[ia + k] == b[ib + k], or `length`.
+ */
+template<class A, class B>
+std::size_t find_match(const A& a, std::size_t ia, const B& b, std::size_t ib, std::size_t length)
+{
+	for (std::size_t k = 0; k < length; k += word_bases)
+	{
+		auto bits = detail::equal_bases(a.word_at(ia + k) ^ b.word_at(ib + k)) & word_mask(length - k);
+		if (bits != 0)
+			return k + detail::first_base(bits);
+	}
+	return length;
+}
+
+/*
+ * First position in [first, last) where a and b hold different bases, or `last`.
+ * Both sequences are read at the same positions.
+ */
+template<class A, class B>
+std::size_t find_mismatch(const A& a, const B& b, std::size_t first, std::size_t last)
+{
+	return first + find_mismatch(a, first, b, first, last - first);
+}
+
+/*
+ * First position in [first, last) where a and b hold the same base, or `last`.
+ */
+template<class A, class B>
+std::size_t find_match(const A& a, const B& b, std::size_t first, std::size_t last)
+{
+	return first + find_match(a, first, b, first, last - first);
+}
+
+/*
+ * Ranges of offsets k in [0, length) where a[ia + k] != b[ib + k].
+ * Used to compare sequences that are shifted against each other by any number
+ * of bases, e.g. after trimming different telomere lengths.
+ */
+template<class A, class B>
+std::vector<base_range> compare_packed(const A& a, std::size_t ia, const B& b, std::size_t ib, std::size_t length)
+{
+	std::vector<base_range> mismatches;
+
+	auto k = find_mismatch(a, ia, b, ib, length);
+	while (k < length)
+	{
+		auto end = k + find_match(a, ia + k, b, ib + k, length - k);
+		mismatches.push_back({ k, end });
+		k = end + find_mismatch(a, ia + end, b, ib + end, length - end);
+	}
+	return mismatches;
+}
+
+/*
+ * Ranges of positions where a and b hold different bases. Positions past the
+ * end of the shorter sequence are reported as one final mismatch range.
+ */
+template<class A, class B>
+std::vector<base_range> compare_packed(const A& a, const B& b)
+{
+	auto common = std::min(a.size(), b.size());
+	auto mismatches = compare_packed(a, 0, b, 0, common);
+
+	auto longest = std::max(a.size(), b.size());
+	if (common < longest)
+	{
+		if (!mismatches.empty() && mismatches.back().last == common)
+			mismatches.back().last = longest;
+		else
+			mismatches.push_back({ common, longest });
+	}
+	return mismatches;
+}
+
+}
@@ -1,17 +1,40 @@
 #pragma once
+#include <algorithm>
 #include <vector>
 #include <atomic>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include "fingerprint.hpp"
+#include "lazy_value.hpp"
+#include "mapped_file.hpp"
+#include "person_file.hpp"
 #include "sequence_buffer.hpp"
+#include "sequence_view.hpp"
+#include "sex.hpp"
+#include "telomere.hpp"
+#include "trim_index.hpp"
+#include "work_stealing_pool.hpp"
 
 namespace dna
 {
 
 	class HelixStream
 	{
-		std::vector<std::byte> data_;
+		// immutable and reference counted: copies of a stream share the bytes and only own a cursor
+		std::shared_ptr<const std::byte> data_;
+		std::size_t length_;
+		const mapped_file* mapping_;
 		std::size_t chunksize_;
 		std::atomic<long> offset_;
+
+		const std::byte* bytes() const noexcept;
+		std::size_t byte_count() const noexcept;
 	public:
 		using byte_view = std::basic_string_view<std::byte/*, detail::binary_traits*/>;
 
@@ -20,6 +43,18 @@ namespace dna
 		HelixStream(HelixStream&& other) noexcept;
 		HelixStream(std::vector<std::byte> data, std::size_t chunksize);
 
+		/*
+		 * Maps a file of packed bases instead of copying it into memory.
+		 * Copies of the stream share the mapping.
+		 */
+		HelixStream(const std::filesystem::path& path, std::size_t chunksize, access_pattern pattern = access_pattern::sequential);
+
+		/*
+		 * Bytes [offset, offset + length) of a mapping shared with other
+		 * streams, e.g. one chromosome of a person file.
+		 */
+		HelixStream(std::shared_ptr<const mapped_file> mapping, std::size_t offset, std::size_t length, std::size_t chunksize);
+
 		HelixStream& operator=(const HelixStream& other);
 		HelixStream& operator=(HelixStream&& other) noexcept;
 
@@ -27,85 +62,181 @@ namespace dna
 		long size() const;
 		dna::sequence_buffer<byte_view> read(std::size_t chunkSize);
 		dna::sequence_buffer<byte_view> read();
+
+		/*
+		 * Reads `length` bytes starting at byte `offset` without touching the
+		 * stream position, so any number of threads can read one stream at once.
+		 */
+		dna::sequence_buffer<byte_view> read_at(std::size_t offset, std::size_t length) const;
+
+		/*
+		 * Bases [first, first + length) as a view into the stream's data,
+		 * clamped to the end of the chromosome like read_at().
+		 */
+		dna::sequence_view<byte_view> view(std::size_t first, std::size_t length) const;
+
+		/*
+		 * Hint how the stream is about to be read. Only has an effect on mapped streams.
+		 */
+		void advise(access_pattern pattern, std::size_t offset = 0, std::size_t length = static_cast<std::size_t>(-1)) const;
 	};
 
-	HelixStream::HelixStream() :
-		data_(0),
+	inline HelixStream::HelixStream() :
+		data_(),
+		length_(0),
+		mapping_(nullptr),
 		chunksize_(1),
 		offset_(0)
 	{ }
 
-	HelixStream::HelixStream(const HelixStream& other) :
+	inline HelixStream::HelixStream(const HelixStream& other) :
 		data_(other.data_),
+		length_(other.length_),
+		mapping_(other.mapping_),
 		chunksize_(other.chunksize_),
 		offset_(other.offset_.load())
 	{ }
 
-	HelixStream::HelixStream(HelixStream&& other) noexcept :
+	inline HelixStream::HelixStream(HelixStream&& other) noexcept :
 		data_(std::move(other.data_)),
+		length_(std::exchange(other.length_, 0)),
+		mapping_(std::exchange(other.mapping_, nullptr)),
 		chunksize_(other.chunksize_),
 		offset_(other.offset_.exchange(0))
 	{ }
 
-	HelixStream::HelixStream(std::vector<std::byte> data, std::size_t chunksize) :
-		data_(std::move(data)),
+	inline HelixStream::HelixStream(std::vector<std::byte> data, std::size_t chunksize) :
+		data_(),
+		length_(data.size()),
+		mapping_(nullptr),
 		chunksize_(chunksize),
 		offset_(0)
-	{ }
+	{
+		auto block = std::make_shared<const std::vector<std::byte>>(std::move(data));
+		data_ = std::shared_ptr<const std::byte>(block, block->data());
+	}
 
-	HelixStream& HelixStream::operator=(const HelixStream& other)
+	inline HelixStream::HelixStream(const std::filesystem::path& path, std::size_t chunksize, access_pattern pattern) :
+		data_(),
+		length_(0),
+		mapping_(nullptr),
+		chunksize_(chunksize),
+		offset_(0)
+	{
+		auto mapping = std::make_shared<const mapped_file>(path);
+		mapping->advise(pattern);
+
+		data_ = std::shared_ptr<const std::byte>(mapping, mapping->data());
+		length_ = mapping->size();
+		mapping_ = mapping.get();
+	}
+
+	inline HelixStream::HelixStream(std::shared_ptr<const mapped_file> mapping, std::size_t offset, std::size_t length, std::size_t chunksize) :
+		data_(),
+		length_(length),
+		mapping_(mapping.get()),
+		chunksize_(chunksize),
+		offset_(0)
+	{
+		if (offset > mapping->size() || length > mapping->size() - offset)
+			throw std::invalid_argument("stream does not fit the mapping");
+
+		data_ = std::shared_ptr<const std::byte>(mapping, mapping->data() + offset);
+	}
+
+	inline HelixStream& HelixStream::operator=(const HelixStream& other)
 	{
 		chunksize_ = other.chunksize_;
 		data_ = other.data_;
+		length_ = other.length_;
+		mapping_ = other.mapping_;
 		offset_ = other.offset_.load();
 
 		return *this;
 	}
 
-	HelixStream& HelixStream::operator=(HelixStream&& other) noexcept
+	inline HelixStream& HelixStream::operator=(HelixStream&& other) noexcept
 	{
 		chunksize_ = other.chunksize_;
 		data_ = std::move(other.data_);
+		length_ = std::exchange(other.length_, 0);
+		mapping_ = std::exchange(other.mapping_, nullptr);
 		offset_ = other.offset_.exchange(0);
 
 		return *this;
 	}
 
-	long HelixStream::size() const
+	inline const std::byte* HelixStream::bytes() const noexcept
 	{
-		return (long)data_.size();
+		return data_.get();
 	}
 
+	inline std::size_t HelixStream::byte_count() const noexcept
+	{
+		return length_;
+	}
 
-	void HelixStream::seek(long offset)
+	inline long HelixStream::size() const
 	{
-		offset_.store(std::min(std::max(offset, 0L), static_cast<long>(data_.size())));
+		return (long)byte_count();
 	}
 
-	sequence_buffer<HelixStream::byte_view> HelixStream::read(std::size_t chunkSize)
+
+	inline void HelixStream::seek(long offset)
+	{
+		offset_.store(std::min(std::max(offset, 0L), static_cast<long>(byte_count())));
+	}
+
+	inline sequence_buffer<HelixStream::byte_view> HelixStream::read(std::size_t chunkSize)
 	{
 		auto offset = offset_.load(std::memory_order_consume);
 		while (true)
 		{
-			auto len = std::min(chunkSize, data_.size() - offset_);
+			auto len = std::min(chunkSize, byte_count() - static_cast<std::size_t>(offset));
 			if (len == 0)
 				return byte_view(nullptr, 0);
 
 			if (offset_.compare_exchange_weak(offset, offset + len, std::memory_order_release))
-				return byte_view(data_.data() + offset, len);
+				return byte_view(bytes() + offset, len);
 		}
 	}
 
-	sequence_buffer<HelixStream::byte_view> HelixStream::read()
+	inline sequence_buffer<HelixStream::byte_view> HelixStream::read()
 	{
 		return HelixStream::read(chunksize_);
 	}
 
+	inline sequence_buffer<HelixStream::byte_view> HelixStream::read_at(std::size_t offset, std::size_t length) const
+	{
+		auto count = byte_count();
+		offset = std::min(offset, count);
+		length = std::min(length, count - offset);
+		if (length == 0)
+			return byte_view(nullptr, 0);
+
+		return byte_view(bytes() + offset, length);
+	}
+
+	inline sequence_view<HelixStream::byte_view> HelixStream::view(std::size_t first, std::size_t length) const
+	{
+		return sequence_view<byte_view>(byte_view(bytes(), byte_count()), first, length);
+	}
+
+	inline void HelixStream::advise(access_pattern pattern, std::size_t offset, std::size_t length) const
+	{
+		if (mapping_ != nullptr)
+			mapping_->advise(pattern, static_cast<std::size_t>(bytes() - mapping_->data()) + offset, std::min(length, length_ - std::min(offset, length_)));
+	}
+
 
 	class Person
 	{
 		std::array<HelixStream, 23> chroms_;
 		std::size_t chunksize_;
+		lazy_value<trim_table> trims_;
+		lazy_value<sex_chromosome> sex_;
+		lazy_value<fingerprint_table> fingerprints_;
+		std::shared_ptr<const sex_classifier> sex_classifier_;
 	public:
 		template<typename T>
 		Person(const T& chromosome_data, std::size_t chunk_size = 512)
@@ -118,7 +249,12 @@ namespace dna
 			std::size_t index = 0;
 			auto it = chromosome_data.begin();
 			for (; index < chromosome_data.size() && it != chromosome_data.end(); ++index, ++it)
-				chroms_[index] = HelixStream(*it, chunk_size);
+			{
+				if constexpr (std::is_same_v<std::decay_t<decltype(*it)>, HelixStream>)
+					chroms_[index] = *it;
+				else
+					chroms_[index] = HelixStream(*it, chunk_size);
+			}
 		}
 
 		const HelixStream& chromosome(std::size_t chromosome_index) const
@@ -134,220 +270,265 @@ namespace dna
 			return chroms_.size();
 		}
 
-		
-
+		/*
+		 * Where the real bases of every chromosome start and end once the
+		 * telomeres are cut off. Both ends of all chromosomes are scanned as
+		 * separate tasks with positional reads. The table is computed once and
+		 * shared with copies made afterwards; the reference stays valid until
+		 * this Person is destroyed or assigned to.
+		 */
+		const trim_table& trim_bounds(work_stealing_pool& pool = work_stealing_pool::shared()) const
+		{
+			return trims_.get([&]() {
+				std::array<telomere_run, 23> heads;
+				std::array<telomere_run, 23> tails;
+				pool.parallel_for(0, 2 * chroms_.size(), 1, [&](std::size_t first, std::size_t last) {
+					for (auto i = first; i < last; ++i)
+					{
+						const auto& chromosome = chroms_[i / 2];
+						auto seq = chromosome.read_at(0, static_cast<std::size_t>(chromosome.size()));
+						if (i % 2 == 0)
+							heads[i / 2] = telomere_run_begin(seq);
+						else
+							tails[i / 2] = telomere_run_end(seq);
+					}
+				});
 
+				trim_table table;
+				for (std::size_t i = 0; i < table.size(); ++i)
+					table[i] = make_trim(static_cast<std::size_t>(chroms_[i].size()) * packed_size::value, heads[i], tails[i]);
+				return table;
+			});
+		}
 
-		/*****************************************************
-		*    Below are the code I wrote for this assignment
-		* ****************************************************
-		*/
+		/*
+		 * Where the real bases of one chromosome start, as in trim_bounds().
+		 * Uses the table if it has been computed or read already, and
+		 * otherwise scans only the head of that chromosome.
+		 */
+		std::size_t trim_begin(std::size_t chromosome_index) const
+		{
+			if (auto trims = trims_.load())
+				return (*trims)[chromosome_index].bounds.first;
 
+			const auto& chrom = chromosome(chromosome_index);
+			auto seq = chrom.read_at(0, static_cast<std::size_t>(chrom.size()));
+			return telomere_run_begin(seq).length;
+		}
 
+		/*
+		 * Writes the trim table to a sidecar file, computing it first if needed.
+		 * See trim_index.hpp for the format.
+		 */
+		void write_trim_index(const std::filesystem::path& path, work_stealing_pool& pool = work_stealing_pool::shared()) const
+		{
+			trim_index::write(path, trim_bounds(pool), chromosome_bases());
+		}
 
 		/*
-		* if index = 159 and count = 4, check if the 4 bases (starting at index 159 of the seq)
-		* match the first 4 bases of a tolemere
-		*/
-		static bool matchTelomereStart(sequence_buffer<HelixStream::byte_view>& seq, size_t index, int count)
+		 * Loads a trim table written by write_trim_index() for this sample, so
+		 * trim_bounds() doesn't have to scan. Throws if the file is missing or
+		 * was written for different data.
+		 */
+		void load_trim_index(const std::filesystem::path& path)
 		{
-			for (int i = 0; i < count; i++)
-			{
-				if (seq[index + i] != telo[i])
-					return false;
-			}
-			return true;
+			trims_.set(trim_index::read(path, chromosome_bases()));
 		}
 
-		static bool matchTelomereEnd(sequence_buffer<HelixStream::byte_view>& seq, size_t index, int count)
+		/*
+		 * Block hash trees over the trimmed bases of every chromosome, see
+		 * block_tree. One task per chromosome; computed once and shared like
+		 * trim_bounds(). Throws std::invalid_argument if the trees there are
+		 * were built with another block size.
+		 */
+		const fingerprint_table& fingerprints(work_stealing_pool& pool = work_stealing_pool::shared(),
+				std::size_t block_bytes = detail::fingerprint_block_bytes) const
 		{
-			for (int i = 0; i < count; i++)
-			{
-				if (seq[index + i] != telo[6-count+i])
-					return false;
-			}
-			return true;
+			const auto& table = fingerprints_.get([&]() {
+				const auto& trims = trim_bounds(pool);
+				fingerprint_table table;
+				pool.parallel_for(0, chroms_.size(), 1, [&](std::size_t first, std::size_t last) {
+					for (auto i = first; i < last; ++i)
+					{
+						auto seq = chroms_[i].read_at(0, static_cast<std::size_t>(chroms_[i].size()));
+						table[i] = block_tree::build(seq, trims[i].bounds, block_bytes);
+					}
+				});
+				return table;
+			});
+			if (table[0].block_bytes() != std::max<std::size_t>(block_bytes, 1))
+				throw std::invalid_argument("block hashes were built with another block size");
+			return table;
 		}
 
 		/*
-		* Find the index of the beginning of the very first telomere
-		*/
-		static int checkFirstTelomereStart(sequence_buffer<HelixStream::byte_view>& seq)
+		 * The block hash trees if they were computed or loaded, without
+		 * computing them. Comparisons only use hashes that already exist.
+		 */
+		std::shared_ptr<const fingerprint_table> known_fingerprints() const
 		{
-			for (int i = 0; i < 6; i++)
-			{
-				if (matchTelomereStart(seq, i, 6))
-					return i;
-			}
+			return fingerprints_.load();
 		}
 
-		static int getTelomereBasesCountBegin(HelixStream& hs)
+		/*
+		 * Writes the block hashes to a sidecar file, computing them with the
+		 * default block size first if needed. See fingerprint.hpp for the format.
+		 */
+		void write_fingerprints(const std::filesystem::path& path, work_stealing_pool& pool = work_stealing_pool::shared()) const
 		{
-			auto seq = hs.read(3); // read 3 bytes = 12 bases, should have at least 1 complete telomere
+			auto known = known_fingerprints();
+			fingerprint_index::write(path, known ? *known : fingerprints(pool), chromosome_bases());
+		}
 
-			int firstTelomereStart = checkFirstTelomereStart(seq);  // index of the start of the very first telomere
-			if (firstTelomereStart == -1)
-				return -1;
+		/*
+		 * Loads block hashes written by write_fingerprints() for this sample.
+		 * Throws if the file is missing or was written for different data.
+		 */
+		void load_fingerprints(const std::filesystem::path& path)
+		{
+			fingerprints_.set(fingerprint_index::read(path, chromosome_bases()));
+		}
 
-			int incompleteTeloBasesAtBeginning = firstTelomereStart; // the first a few bases that don't form a *complete* telomere, but should match the end of a telomere
+		/*
+		 * Opens a person file (see person_file.hpp): one mapping shared by all
+		 * chromosomes and a parse of its header, nothing is read until used.
+		 * Trim bounds stored in the file are taken as they are once decode()
+		 * has checked that they lie within their chromosomes.
+		 */
+		static Person open(const std::filesystem::path& path, std::size_t chunk_size = 512)
+		{
+			auto mapping = std::make_shared<const mapped_file>(path);
+			auto file = person_file::decode(mapping->data(), mapping->size());
+
+			std::array<HelixStream, 23> streams;
+			for (std::size_t i = 0; i < streams.size(); ++i)
+				streams[i] = HelixStream(mapping, file.chromosomes[i].offset, file.chromosomes[i].bytes(), chunk_size);
+
+			Person person(streams, chunk_size);
+			if (file.trims)
+				person.trims_.set(*file.trims);
+			if (file.sex != sex_chromosome::unknown)
+				person.sex_.set(file.sex);
+			return person;
+		}
 
-			hs.seek(0);
-			int readBytes = 512;			
-			int seqLength = readBytes * 4;
-			int checkedBases = 0;
+		/*
+		 * Writes this person as a person file, with its sex and, unless
+		 * `with_trims` is false, its trim bounds; both are computed first if needed.
+		 */
+		void save(const std::filesystem::path& path, bool with_trims = true, work_stealing_pool& pool = work_stealing_pool::shared()) const
+		{
+			std::optional<trim_table> trims;
+			if (with_trims)
+				trims = trim_bounds(pool);
 
-			while (true)
+			std::array<std::span<const std::byte>, 23> payloads;
+			for (std::size_t i = 0; i < payloads.size(); ++i)
 			{
-				seq = hs.read(readBytes);
-
-				int potentialCompleteTelo = (seqLength - incompleteTeloBasesAtBeginning) / 6;
-				int incompleteTeloBasesAtTail = (seqLength - incompleteTeloBasesAtBeginning - potentialCompleteTelo * 6);
-				
-				if (matchTelomereEnd(seq, 0, incompleteTeloBasesAtBeginning))
-				{
-					checkedBases += incompleteTeloBasesAtBeginning;
-				}
-				else
-				{
-					/*
-					* What should I do? Should I declare this gene is "damaged" just because the first a few bases
-					* don't match the end of the telomere? But I may be able to find hundreds of complete telomeres
-					* right after that first a few.
-					*/
-				}
-
-
-				int start = 0, end = potentialCompleteTelo - 1;
-				while (start < end)
-				{
-					int mid = start + (end - start) / 2;
-					int midIndex = incompleteTeloBasesAtBeginning + mid * 6;
-					if (matchTelomereStart(seq, midIndex, 6))
-						start = mid + 1;
-					else
-						end = mid - 1;
-				}
-
-				if (matchTelomereStart(seq, incompleteTeloBasesAtBeginning + start * 6, 6))
-				{
-					if (start == potentialCompleteTelo - 1)
-					{
-						// every potentail complete telomere is valid
-						if (matchTelomereStart(seq, seqLength - incompleteTeloBasesAtTail, incompleteTeloBasesAtTail))
-						{
-							checkedBases += (potentialCompleteTelo*6 + incompleteTeloBasesAtTail);
-							incompleteTeloBasesAtBeginning = 6 - incompleteTeloBasesAtTail;
-						}
-						else
-						{
-							checkedBases += (potentialCompleteTelo * 6);
-							return checkedBases;
-						}
-					}
-					else
-					{
-						checkedBases += ((start+1) * 6);
-						return checkedBases;
-					}
-				}
-				else
-				{
-					checkedBases += start * 6;
-					return checkedBases;
-				}
+				auto bytes = chroms_[i].read_at(0, static_cast<std::size_t>(chroms_[i].size())).buffer();
+				payloads[i] = { bytes.data(), bytes.size() };
 			}
+			person_file::write(path, person_file::plan(chromosome_bases(), sex(), trims), payloads);
 		}
 
-
 		/*
-		*  0  1  2  3  4  5  6  7  8  9  10  11
-		*     |              |
-		*     |              if the last telomere starts here, then there is no incomplete telomere
-		*     if the last telomere starts here, then there are 5 extra bases that should match the beginning of a telomere
-		*/
-		static int checkLastTelomereStart(sequence_buffer<HelixStream::byte_view>& seq)
+		 * Whether chromosome 23 is an X or a Y, see classify_sex(). Decided
+		 * by length alone unless set_sex_classifier() gave Y probes for a
+		 * chromosome too short to tell. Computed once and shared like
+		 * trim_bounds().
+		 */
+		sex_chromosome sex() const
 		{
-			for (int i = 1; i <= 6; i++)
-			{
-				if (matchTelomereStart(seq, i, 6))
-					return i;
-			}
+			return sex_.get([&]() {
+				const auto& chromosome = chroms_[22];
+				auto seq = chromosome.read_at(0, static_cast<std::size_t>(chromosome.size()));
+				return sex_classifier_ ? classify_sex(seq, *sex_classifier_) : classify_sex(seq);
+			});
 		}
 
-		static int getTelomereBasesCountEnd(HelixStream& hs)
+		/*
+		 * Classifies chromosome 23 with `classifier` from now on, usually to
+		 * add Y probes. Forgets a sex already computed or read from a person
+		 * file; copies made before keep theirs.
+		 */
+		void set_sex_classifier(sex_classifier classifier)
 		{
-			long totalBytes = hs.size();
-			hs.seek(totalBytes - 3);
-			auto seq = hs.read(3);
-
-			int lastTelomereStart = checkLastTelomereStart(seq);
-			if (lastTelomereStart == -1)
-				return -1;
-
-			int incompleteTeloBasesAtEnd = 12 - (lastTelomereStart + 6);
+			sex_classifier_ = std::make_shared<const sex_classifier>(std::move(classifier));
+			sex_ = lazy_value<sex_chromosome>();
+		}
 
-			int readBytes = 512;
-			int seqLength = readBytes * 4;
-			int checkedBases = 0;
-			int seekOffsetMultiple = 1;
+		std::array<std::size_t, 23> chromosome_bases() const
+		{
+			std::array<std::size_t, 23> sizes;
+			for (std::size_t i = 0; i < sizes.size(); ++i)
+				sizes[i] = static_cast<std::size_t>(chroms_[i].size()) * packed_size::value;
+			return sizes;
+		}
 
-			while (true)
+		/*
+		 * Calls f(index, chromosome) for every chromosome as a task on `pool` and
+		 * waits for all of them. The largest chromosomes are submitted first so
+		 * they don't end up running alone at the end. f may submit chunk tasks of
+		 * its own to the same pool.
+		 */
+		template<class F>
+		void for_each_chromosome(work_stealing_pool& pool, F&& f) const
+		{
+			std::array<std::size_t, 23> order;
+			for (std::size_t i = 0; i < order.size(); ++i)
+				order[i] = i;
+			std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+				return chroms_[a].size() > chroms_[b].size();
+			});
+
+			std::vector<std::future<void>> tasks;
+			for (auto index : order)
+				tasks.push_back(pool.submit([&f, this, index]() { f(index, chroms_[index]); }));
+
+			std::exception_ptr error;
+			for (auto& task : tasks)
 			{
-				hs.seek(totalBytes - seekOffsetMultiple * 512);
-				seq = hs.read(readBytes);
-
-				int potentialCompleteTelo = (seqLength - incompleteTeloBasesAtEnd) / 6;
-				int incompleteTeloBasesAtBegin = (seqLength - incompleteTeloBasesAtEnd - potentialCompleteTelo * 6);
-
-				if (matchTelomereStart(seq, seqLength - incompleteTeloBasesAtEnd, incompleteTeloBasesAtEnd))
+				try
 				{
-					checkedBases += incompleteTeloBasesAtEnd;
+					pool.wait(task);
 				}
-				else
+				catch (...)
 				{
-
+					if (!error)
+						error = std::current_exception();
 				}
+			}
+			if (error)
+				std::rethrow_exception(error);
+		}
 
-				int start = 0, end = potentialCompleteTelo - 1;
-				while (start < end)
-				{
-					int mid = start + (end - start) / 2;
-					int midIndex = seqLength - ((mid+1) * 6 + incompleteTeloBasesAtEnd);
-					if (matchTelomereStart(seq, midIndex, 6))
-						start = mid + 1;
-					else
-						end = mid - 1;
-				}
+		
 
-				if (matchTelomereStart(seq, seqLength - ((start+1) * 6 + incompleteTeloBasesAtEnd), 6))
-				{
-					if (start == potentialCompleteTelo - 1)
-					{
-						if (matchTelomereEnd(seq, 0, incompleteTeloBasesAtBegin))
-						{
-							checkedBases += (potentialCompleteTelo * 6 + incompleteTeloBasesAtBegin);
-							incompleteTeloBasesAtEnd = 6 - incompleteTeloBasesAtBegin;
-						}
-						else
-						{
-							checkedBases += (potentialCompleteTelo * 6);
-							return checkedBases;
-						}
-					}
-					else
-					{
-						checkedBases += ((start + 1) * 6);
-						return checkedBases;
-					}
-				}
-				else
-				{
-					checkedBases += start * 6;
-					return checkedBases;
-				}
 
-				seekOffsetMultiple++;
-			}
+
+		/*****************************************************
+		*    Below are the code I wrote for this assignment
+		* ****************************************************
+		*/
+
+
+
+		/*
+		* Number of telomere bases at the start of a chromosome, see telomere_run_begin().
+		*/
+		static int getTelomereBasesCountBegin(const HelixStream& hs)
+		{
+			auto seq = hs.read_at(0, static_cast<std::size_t>(hs.size()));
+			return static_cast<int>(telomere_run_begin(seq).length);
+		}
+
+		/*
+		* Number of telomere bases at the end of a chromosome, see telomere_run_end().
+		*/
+		static int getTelomereBasesCountEnd(const HelixStream& hs)
+		{
+			auto seq = hs.read_at(0, static_cast<std::size_t>(hs.size()));
+			return static_cast<int>(telomere_run_end(seq).length);
 		}
 	};
 }
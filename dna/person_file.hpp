@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "sex.hpp"
+#include "telomere.hpp"
+#include "trim_index.hpp"
+
+namespace dna
+{
+
+/*
+ * A whole person in one file, so opening one is a single mmap and a header
+ * parse instead of loading 23 files or 750 MB of vectors. Every chromosome
+ * starts on a 4 KiB boundary, so reading one only faults in its own pages.
+ *
+ * All integers are little endian.
+ *   header  8 bytes "DNAPERS1", uint32 version, uint32 chromosome count,
+ *           uint32 payload alignment, uint8 sex (see sex_chromosome),
+ *           uint8 flags (bit 0: trim bounds present), 2 bytes padding
+ *   then per chromosome, 40 bytes:
+ *     uint64 byte offset of the packed bases, uint64 size in bases,
+ *     uint32 first real base, uint32 end of real bases,
+ *     uint32 head repeats, uint32 tail repeats,
+ *     uint8 head partial, uint8 tail partial, 6 bytes padding
+ *   then the packed bases of each chromosome, zero padded to the alignment.
+ * The trim fields are zero unless flag bit 0 is set.
+ */
+namespace person_file
+{
+
+constexpr char magic[8] = { 'D', 'N', 'A', 'P', 'E', 'R', 'S', '1' };
+constexpr std::uint32_t version = 1;
+constexpr std::size_t chromosome_count = 23;
+constexpr std::size_t header_size = 24;
+constexpr std::size_t record_size = 40;
+constexpr std::size_t payload_alignment = 4096;
+constexpr std::uint8_t has_trims = 0x01;
+
+struct chromosome_entry
+{
+	std::size_t offset;
+	std::size_t bases;
+
+	std::size_t bytes() const noexcept
+	{
+		return (bases + packed_size::value - 1) / packed_size::value;
+	}
+};
+
+struct layout
+{
+	sex_chromosome sex = sex_chromosome::unknown;
+	std::optional<trim_table> trims;
+	std::array<chromosome_entry, chromosome_count> chromosomes{};
+};
+
+namespace detail
+{
+
+using trim_index::detail::get_u32;
+using trim_index::detail::put_u32;
+
+inline void put_u64(std::byte* out, std::uint64_t value)
+{
+	put_u32(out, static_cast<std::uint32_t>(value));
+	put_u32(out + 4, static_cast<std::uint32_t>(value >> 32));
+}
+
+inline std::uint64_t get_u64(const std::byte* in)
+{
+	return get_u32(in) | (std::uint64_t{ get_u32(in + 4) } << 32);
+}
+
+constexpr std::size_t align(std::size_t offset)
+{
+	return (offset + payload_alignment - 1) / payload_alignment * payload_alignment;
+}
+
+}
+
+/*
+ * Places chromosomes of the given sizes one after the other behind the header.
+ */
+inline layout plan(const std::array<std::size_t, chromosome_count>& bases, sex_chromosome sex = sex_chromosome::unknown,
+		std::optional<trim_table> trims = std::nullopt)
+{
+	layout result{ sex, std::move(trims), {} };
+	auto offset = detail::align(header_size + chromosome_count * record_size);
+	for (std::size_t i = 0; i < chromosome_count; ++i)
+	{
+		result.chromosomes[i] = { offset, bases[i] };
+		offset = detail::align(offset + result.chromosomes[i].bytes());
+	}
+	return result;
+}
+
+/*
+ * The header and records, zero padded to where the first chromosome starts.
+ */
+inline std::vector<std::byte> encode(const layout& file)
+{
+	std::vector<std::byte> out(file.chromosomes[0].offset);
+	for (std::size_t i = 0; i < sizeof(magic); ++i)
+		out[i] = static_cast<std::byte>(magic[i]);
+	detail::put_u32(out.data() + 8, version);
+	detail::put_u32(out.data() + 12, static_cast<std::uint32_t>(chromosome_count));
+	detail::put_u32(out.data() + 16, static_cast<std::uint32_t>(payload_alignment));
+	out[20] = static_cast<std::byte>(file.sex);
+	out[21] = static_cast<std::byte>(file.trims ? has_trims : 0);
+
+	for (std::size_t i = 0; i < chromosome_count; ++i)
+	{
+		auto* record = out.data() + header_size + i * record_size;
+		detail::put_u64(record, file.chromosomes[i].offset);
+		detail::put_u64(record + 8, file.chromosomes[i].bases);
+		if (!file.trims)
+			continue;
+
+		const auto& trim = (*file.trims)[i];
+		detail::put_u32(record + 16, static_cast<std::uint32_t>(trim.bounds.first));
+		detail::put_u32(record + 20, static_cast<std::uint32_t>(trim.bounds.last));
+		detail::put_u32(record + 24, static_cast<std::uint32_t>(trim.head.repeats));
+		detail::put_u32(record + 28, static_cast<std::uint32_t>(trim.tail.repeats));
+		record[32] = static_cast<std::byte>(trim.head.partial);
+		record[33] = static_cast<std::byte>(trim.tail.partial);
+	}
+	return out;
+}
+
+/*
+ * Parses the header of a person file of `size` bytes and checks that every
+ * chromosome lies within it and every stored trim within its chromosome.
+ * Throws std::runtime_error otherwise.
+ */
+inline layout decode(const std::byte* data, std::size_t size)
+{
+	if (size < header_size + chromosome_count * record_size)
+		throw std::runtime_error("person file is too short");
+	for (std::size_t i = 0; i < sizeof(magic); ++i)
+	{
+		if (data[i] != static_cast<std::byte>(magic[i]))
+			throw std::runtime_error("not a person file");
+	}
+	if (detail::get_u32(data + 8) != version || detail::get_u32(data + 12) != chromosome_count ||
+			detail::get_u32(data + 16) != payload_alignment)
+		throw std::runtime_error("unsupported person file version");
+
+	auto sex = std::to_integer<std::uint8_t>(data[20]);
+	if (sex > static_cast<std::uint8_t>(sex_chromosome::y))
+		throw std::runtime_error("person file has an invalid sex");
+
+	layout file;
+	file.sex = static_cast<sex_chromosome>(sex);
+	bool trims = (std::to_integer<std::uint8_t>(data[21]) & has_trims) != 0;
+	if (trims)
+		file.trims.emplace();
+
+	for (std::size_t i = 0; i < chromosome_count; ++i)
+	{
+		const auto* record = data + header_size + i * record_size;
+		auto& entry = file.chromosomes[i];
+		entry = { static_cast<std::size_t>(detail::get_u64(record)), static_cast<std::size_t>(detail::get_u64(record + 8)) };
+		if (entry.offset % payload_alignment != 0 || entry.offset > size || entry.bytes() > size - entry.offset)
+			throw std::runtime_error("person file chromosome does not fit the file");
+		if (!trims)
+			continue;
+
+		(*file.trims)[i] = trim_index::detail::stored_trim(entry.bytes() * packed_size::value,
+				detail::get_u32(record + 16), detail::get_u32(record + 20),
+				detail::get_u32(record + 24), std::to_integer<std::size_t>(record[32]),
+				detail::get_u32(record + 28), std::to_integer<std::size_t>(record[33]));
+	}
+	return file;
+}
+
+/*
+ * Writes a person file; payloads[i] holds the packed bases of chromosome i
+ * and must be as long as the layout says.
+ */
+inline void write(const std::filesystem::path& path, const layout& file,
+		const std::array<std::span<const std::byte>, chromosome_count>& payloads)
+{
+	auto header = encode(file);
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+	const std::vector<char> padding(payload_alignment);
+	std::size_t offset = header.size();
+	for (std::size_t i = 0; i < chromosome_count; ++i)
+	{
+		const auto& entry = file.chromosomes[i];
+		if (payloads[i].size() != entry.bytes() || entry.offset < offset)
+			throw std::invalid_argument("chromosome data does not match the person file layout");
+
+		out.write(padding.data(), static_cast<std::streamsize>(entry.offset - offset));
+		out.write(reinterpret_cast<const char*>(payloads[i].data()), static_cast<std::streamsize>(payloads[i].size()));
+		offset = entry.offset + payloads[i].size();
+	}
+	out.write(padding.data(), static_cast<std::streamsize>(detail::align(offset) - offset));
+	if (!out)
+		throw std::runtime_error("unable to write " + path.string());
+}
+
+}
+
+}
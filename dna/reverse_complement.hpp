@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include "base.hpp"
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+namespace detail
+{
+
+/*
+ * Reverses the order of the 32 bases in a word: bytes, then the nibbles in
+ * every byte, then the base pairs in every nibble.
+ */
+constexpr packed_word reverse_bases(packed_word word)
+{
+	word = __builtin_bswap64(word);
+	word = ((word >> 4) & 0x0f0f0f0f0f0f0f0full) | ((word & 0x0f0f0f0f0f0f0f0full) << 4);
+	word = ((word >> 2) & 0x3333333333333333ull) | ((word & 0x3333333333333333ull) << 2);
+	return word;
+}
+
+}
+
+/*
+ * The opposite strand of a sequence, read in its own 5' to 3' direction:
+ * base i is the complement of base size() - 1 - i. Nothing is copied; the
+ * view refers to the buffer, which has to outlive it.
+ */
+template<class T>
+class reverse_complement_view
+{
+	const sequence_buffer<T>* seq_;
+public:
+	using iterator = sequence_iterator<reverse_complement_view>;
+
+	constexpr explicit reverse_complement_view(const sequence_buffer<T>& sequence) noexcept :
+			seq_(&sequence)
+	{ }
+
+	constexpr std::size_t size() const noexcept
+	{
+		return seq_->size();
+	}
+
+	constexpr base at(std::size_t index) const
+	{
+		return complement(seq_->at(seq_->size() - 1 - index));
+	}
+
+	constexpr base operator[](std::size_t index) const
+	{
+		return at(index);
+	}
+
+	/*
+	 * Bases [index, index + 32) of the opposite strand, built from one word of
+	 * the forward strand by reversing and complementing it.
+	 */
+	packed_word word_at(std::size_t index) const
+	{
+		auto size = seq_->size();
+		if (index >= size)
+			return 0;
+
+		auto end = size - index;
+		if (end >= word_bases)
+			return ~detail::reverse_bases(seq_->word_at(end - word_bases));
+
+		// fewer than 32 bases are left: they end up in the low bits and move back to the top
+		auto count = end;
+		auto word = detail::reverse_bases(seq_->word_at(0)) << (2 * (word_bases - count));
+		return ~word & word_mask(count);
+	}
+
+	block_range<reverse_complement_view> blocks() const noexcept
+	{
+		return block_range<reverse_complement_view>(this);
+	}
+
+	constexpr iterator begin() const noexcept
+	{
+		return iterator(this, 0);
+	}
+
+	constexpr iterator end() const noexcept
+	{
+		return iterator(this, size());
+	}
+};
+
+template<class T>
+reverse_complement_view<T> reverse_complement(const sequence_buffer<T>& sequence)
+{
+	return reverse_complement_view<T>(sequence);
+}
+
+template<class T>
+std::ostream& operator<<(std::ostream& os, const reverse_complement_view<T>& view)
+{
+	for (auto b : view)
+		os << b;
+	return os;
+}
+
+}
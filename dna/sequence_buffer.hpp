@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <algorithm>
+#include <iterator>
 #include "base.hpp"
 
 namespace dna
@@ -115,6 +117,193 @@ public:
 
 };
 
+/*
+ * Half-open range of base positions [first, last).
+ */
+struct base_range
+{
+	std::size_t first;
+	std::size_t last;
+
+	constexpr std::size_t size() const noexcept
+	{
+		return last - first;
+	}
+
+	constexpr bool operator==(const base_range& other) const noexcept
+	{
+		return first == other.first && last == other.last;
+	}
+
+	constexpr bool operator!=(const base_range& other) const noexcept
+	{
+		return !operator==(other);
+	}
+};
+
+inline std::ostream& operator<<(std::ostream& os, const base_range& range)
+{
+	return os << '[' << range.first << ", " << range.last << ')';
+}
+
+/*
+ * Up to 32 bases of a sequence starting at `index`. `mask` keeps the `count`
+ * valid bases of `word`; it is only partial for the last block of a sequence.
+ */
+struct packed_block
+{
+	std::size_t index;
+	std::size_t count;
+	packed_word word;
+	packed_word mask;
+};
+
+/*
+ * Walks any sequence that provides size() and word_at() 32 bases at a time.
+ */
+template<class S>
+class block_iterator
+{
+	const S* seq_;
+	std::size_t index_;
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = packed_block;
+	using difference_type = long;
+
+	constexpr block_iterator() noexcept :
+			seq_(nullptr),
+			index_(0)
+	{ }
+
+	constexpr block_iterator(const S* sequence, std::size_t index = 0) noexcept :
+			seq_(sequence),
+			index_(index)
+	{ }
+
+	value_type operator*() const
+	{
+		auto count = std::min(word_bases, seq_->size() - index_);
+		return { index_, count, seq_->word_at(index_), word_mask(count) };
+	}
+
+	constexpr block_iterator& operator++() noexcept
+	{
+		index_ += word_bases;
+		return *this;
+	}
+
+	constexpr block_iterator operator++(int) noexcept
+	{
+		block_iterator result = *this;
+		index_ += word_bases;
+		return result;
+	}
+
+	constexpr bool operator==(const block_iterator& other) const noexcept
+	{
+		return seq_ == other.seq_ && index_ == other.index_;
+	}
+
+	constexpr bool operator!=(const block_iterator& other) const noexcept
+	{
+		return !operator==(other);
+	}
+};
+
+template<class S>
+class block_range
+{
+	const S* seq_;
+public:
+	using iterator = block_iterator<S>;
+
+	constexpr explicit block_range(const S* sequence) noexcept :
+			seq_(sequence)
+	{ }
+
+	constexpr iterator begin() const noexcept
+	{
+		return iterator(seq_, 0);
+	}
+
+	constexpr iterator end() const noexcept
+	{
+		auto blocks = (seq_->size() + word_bases - 1) / word_bases;
+		return iterator(seq_, blocks * word_bases);
+	}
+};
+
+/*
+ * Walks any sequence that provides size() and at() one base at a time.
+ */
+template<class S>
+class sequence_iterator
+{
+	const S* seq_;
+	std::size_t index_;
+public:
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = base;
+	using difference_type = long;
+
+	constexpr sequence_iterator() noexcept :
+			seq_(nullptr),
+			index_(0)
+	{ }
+
+	constexpr sequence_iterator(const S* sequence, std::size_t index = 0) noexcept :
+			seq_(sequence),
+			index_(index)
+	{ }
+
+	constexpr value_type operator*() const
+	{
+		return seq_->at(index_);
+	}
+
+	constexpr sequence_iterator& operator++() noexcept
+	{
+		++index_;
+		return *this;
+	}
+
+	constexpr sequence_iterator operator++(int) noexcept
+	{
+		sequence_iterator result = *this;
+		++index_;
+		return result;
+	}
+
+	constexpr sequence_iterator& operator--() noexcept
+	{
+		--index_;
+		return *this;
+	}
+
+	constexpr sequence_iterator operator--(int) noexcept
+	{
+		sequence_iterator result = *this;
+		--index_;
+		return result;
+	}
+
+	constexpr long operator-(const sequence_iterator& other) const noexcept
+	{
+		return static_cast<long>(index_ - other.index_);
+	}
+
+	constexpr bool operator==(const sequence_iterator& other) const noexcept
+	{
+		return seq_ == other.seq_ && index_ == other.index_;
+	}
+
+	constexpr bool operator!=(const sequence_iterator& other) const noexcept
+	{
+		return !operator==(other);
+	}
+};
+
 template<class T>
 class sequence_buffer
 {
@@ -136,7 +325,7 @@ public:
 		auto boffset = index / packed_size::value;
 		auto tidx = index - (boffset * packed_size::value);
 
-		return unpack(buffer_[boffset])[tidx];
+		return unpack_at(buffer_[boffset], tidx);
 	}
 
 	constexpr base operator[](std::size_t index) const
@@ -144,6 +333,27 @@ public:
 		return at(index);
 	}
 
+	/*
+	 * Bases [index, index + 32) packed into one word, see load_packed_word().
+	 * Bases past the end of the buffer read as zero.
+	 */
+	packed_word word_at(std::size_t index) const
+	{
+		if (index >= size_)
+			return 0;
+		return load_packed_word(data(), std::size(buffer_), index) & word_mask(size_ - index);
+	}
+
+	block_range<sequence_buffer> blocks() const noexcept
+	{
+		return block_range<sequence_buffer>(this);
+	}
+
+	const std::byte* data() const noexcept
+	{
+		return std::data(buffer_);
+	}
+
 	constexpr std::size_t size() const noexcept
 	{
 		return size_;
@@ -166,7 +376,7 @@ public:
 
 	constexpr T& buffer() noexcept
 	{
-		buffer_;
+		return buffer_;
 	}
 };
 
@@ -179,6 +389,28 @@ constexpr typename sequence_buffer_iterator<T>::value_type sequence_buffer_itera
 	return A;
 }
 
+/*
+ * Number of each base in a sequence, indexed by the value of dna::base.
+ * Counted a block at a time: a base matches where both bits of (word ^ ~pattern) are set.
+ */
+template<class S>
+std::array<std::size_t, 4> histogram(const S& seq)
+{
+	constexpr packed_word low_bits = 0x5555555555555555ull;
+
+	std::array<std::size_t, 4> counts{};
+	for (auto block : seq.blocks())
+	{
+		for (std::size_t b = 0; b + 1 < counts.size(); ++b)
+		{
+			auto same = ~(block.word ^ (low_bits * b)) & block.mask;
+			counts[b] += static_cast<std::size_t>(__builtin_popcountll(same & (same >> 1) & low_bits));
+		}
+	}
+	counts[3] = seq.size() - counts[0] - counts[1] - counts[2];
+	return counts;
+}
+
 template<class T>
 std::ostream& operator<<(std::ostream& os, const sequence_buffer<T>& buf)
 {
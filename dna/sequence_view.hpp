@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include "base.hpp"
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+/*
+ * A run of bases that may start anywhere inside its packed storage, not only
+ * on a byte boundary. T is held by value, so a view over a string_view or a
+ * span copies nothing; subviews share the same storage.
+ */
+template<class T>
+class sequence_view
+{
+	T storage_;
+	std::size_t first_;
+	std::size_t length_;
+public:
+	using iterator = sequence_iterator<sequence_view>;
+
+	/*
+	 * Bases [first, first + length) of the storage, clamped to its end.
+	 */
+	constexpr sequence_view(T storage, std::size_t first, std::size_t length) :
+			storage_(std::move(storage)),
+			first_(0),
+			length_(0)
+	{
+		auto total = static_cast<std::size_t>(std::size(storage_) * packed_size::value);
+		first_ = std::min(first, total);
+		length_ = std::min(length, total - first_);
+	}
+
+	constexpr explicit sequence_view(const sequence_buffer<T>& buffer) :
+			sequence_view(buffer.buffer(), 0, buffer.size())
+	{ }
+
+	/*
+	 * Bases [pos, pos + length) of this view, clamped like std::string_view::substr.
+	 */
+	constexpr sequence_view subview(std::size_t pos, std::size_t length = static_cast<std::size_t>(-1)) const
+	{
+		pos = std::min(pos, length_);
+		return sequence_view(storage_, first_ + pos, std::min(length, length_ - pos));
+	}
+
+	constexpr base at(std::size_t index) const
+	{
+		auto position = first_ + index;
+		return unpack_at(storage_[position / packed_size::value], position % packed_size::value);
+	}
+
+	constexpr base operator[](std::size_t index) const
+	{
+		return at(index);
+	}
+
+	/*
+	 * Bases [index, index + 32) of the view; bases past its end read as zero.
+	 */
+	packed_word word_at(std::size_t index) const
+	{
+		if (index >= length_)
+			return 0;
+		return load_packed_word(data(), std::size(storage_), first_ + index) & word_mask(length_ - index);
+	}
+
+	block_range<sequence_view> blocks() const noexcept
+	{
+		return block_range<sequence_view>(this);
+	}
+
+	/*
+	 * The packed storage; base 0 of the view is base first_base() of it.
+	 */
+	const std::byte* data() const noexcept
+	{
+		return std::data(storage_);
+	}
+
+	constexpr std::size_t first_base() const noexcept
+	{
+		return first_;
+	}
+
+	constexpr std::size_t size() const noexcept
+	{
+		return length_;
+	}
+
+	constexpr bool empty() const noexcept
+	{
+		return length_ == 0;
+	}
+
+	constexpr iterator begin() const noexcept
+	{
+		return iterator(this, 0);
+	}
+
+	constexpr iterator end() const noexcept
+	{
+		return iterator(this, length_);
+	}
+
+	constexpr const T& storage() const noexcept
+	{
+		return storage_;
+	}
+};
+
+template<class T>
+sequence_view(const sequence_buffer<T>&) -> sequence_view<T>;
+
+/*
+ * Views hold the same bases, wherever they sit in their storage.
+ * Compared 32 bases at a time.
+ */
+template<class T, class U>
+bool operator==(const sequence_view<T>& a, const sequence_view<U>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (std::size_t i = 0; i < a.size(); i += word_bases)
+		if (a.word_at(i) != b.word_at(i))
+			return false;
+	return true;
+}
+
+template<class T, class U>
+bool operator!=(const sequence_view<T>& a, const sequence_view<U>& b)
+{
+	return !(a == b);
+}
+
+template<class T>
+std::ostream& operator<<(std::ostream& os, const sequence_view<T>& view)
+{
+	for (auto b : view)
+		os << b;
+	return os;
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "kmer.hpp"
+
+namespace dna
+{
+
+/*
+ * What chromosome 23 of a person is, if known.
+ */
+enum class sex_chromosome : std::uint8_t
+{
+	unknown,
+	x,
+	y
+};
+
+/*
+ * How chromosome 23 is told apart. An X has about 156M bases and a Y about
+ * 57M, and sequencing only ever loses bases at the ends, so anything longer
+ * than any Y is an X and anything near a Y's length is taken to be one.
+ * Only a chromosome shorter than that has lost so much that its length says
+ * nothing; it is sampled for k-mers that occur on Y only. Without probes
+ * there is no evidence either way and it stays unknown.
+ *
+ * The probes are up to 32 bases each, packed like kmer_at() with
+ * `probe_bases` bases; they must come from a Y reference and are not shipped.
+ */
+struct sex_classifier
+{
+	std::size_t y_max_bases = 64'000'000;
+	std::size_t y_min_bases = 40'000'000;
+
+	std::vector<kmer> y_probes;
+	std::size_t probe_bases = 32;
+
+	// windows sampled evenly over the chromosome, and how many probe hits make a Y
+	std::size_t samples = 64;
+	std::size_t sample_bases = 4096;
+	std::size_t min_hits = 2;
+};
+
+/*
+ * Number of probe k-mers found in `samples` windows spread over `seq`.
+ */
+template<class S>
+std::size_t count_probe_hits(const S& seq, const sex_classifier& classifier)
+{
+	if (classifier.y_probes.empty() || seq.size() < classifier.probe_bases || classifier.samples == 0)
+		return 0;
+
+	auto probes = classifier.y_probes;
+	std::sort(probes.begin(), probes.end());
+
+	auto window = std::min(classifier.sample_bases, seq.size());
+	auto span = seq.size() - window;
+	std::size_t hits = 0;
+	for (std::size_t s = 0; s < classifier.samples; ++s)
+	{
+		auto first = classifier.samples == 1 ? 0 : span * s / (classifier.samples - 1);
+		for (auto p = first; p + classifier.probe_bases <= first + window; ++p)
+			hits += std::binary_search(probes.begin(), probes.end(), kmer_at(seq, p, classifier.probe_bases));
+	}
+	return hits;
+}
+
+/*
+ * Whether chromosome 23 is an X or a Y; see sex_classifier. Only reads bases
+ * when the length alone can't tell. Unknown for an empty chromosome and for
+ * one too short to tell when there are no probes.
+ */
+template<class S>
+sex_chromosome classify_sex(const S& seq, const sex_classifier& classifier = {})
+{
+	auto bases = seq.size();
+	if (bases == 0)
+		return sex_chromosome::unknown;
+	if (bases > classifier.y_max_bases)
+		return sex_chromosome::x;
+	if (bases >= classifier.y_min_bases)
+		return sex_chromosome::y;
+	if (classifier.y_probes.empty())
+		return sex_chromosome::unknown;
+	return count_probe_hits(seq, classifier) >= classifier.min_hits ? sex_chromosome::y : sex_chromosome::x;
+}
+
+}
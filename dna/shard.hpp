@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "align.hpp"
+#include "difference.hpp"
+#include "packed_compare.hpp"
+#include "person.hpp"
+
+namespace dna
+{
+
+/*
+ * The pair of positions, one in each person, that a chromosome comparison was
+ * lined up on.
+ */
+struct alignment_anchor
+{
+	std::size_t a;
+	std::size_t b;
+
+	constexpr bool operator==(const alignment_anchor& other) const noexcept
+	{
+		return a == other.a && b == other.b;
+	}
+};
+
+/*
+ * A self-contained unit of comparison work, small enough to hand to a map
+ * task of an external map-reduce framework. The framework resolves the person
+ * ids; map() only needs the two people and the shard.
+ *
+ * The bases in range_a are compared with the bases in range_b from their
+ * starts, following indels (see align_packed()). If one range is longer,
+ * whatever is left of either side at the end is reported as unmatched, which
+ * is how the final shard of a chromosome carries the tails. Indels shift
+ * everything after them, so a shard that starts out of step with b first
+ * finds its diagonal again from the bases just ahead of it.
+ */
+struct ComparisonShard
+{
+	std::string person_a;
+	std::string person_b;
+	std::size_t chromosome;
+	base_range range_a;
+	base_range range_b;
+	alignment_anchor anchor;
+
+	bool operator==(const ComparisonShard& other) const
+	{
+		return person_a == other.person_a && person_b == other.person_b && chromosome == other.chromosome &&
+				range_a == other.range_a && range_b == other.range_b && anchor == other.anchor;
+	}
+};
+
+/*
+ * The differences found by one or more shards, ordered by chromosome and position.
+ */
+struct partial_diffs
+{
+	std::vector<difference> diffs;
+};
+
+/*
+ * One tab separated line, e.g. for Hadoop streaming. Person ids must not
+ * contain tabs or newlines.
+ */
+inline std::string serialize(const ComparisonShard& shard)
+{
+	std::ostringstream out;
+	out << shard.person_a << '\t' << shard.person_b << '\t' << shard.chromosome << '\t'
+			<< shard.range_a.first << '\t' << shard.range_a.last << '\t'
+			<< shard.range_b.first << '\t' << shard.range_b.last << '\t'
+			<< shard.anchor.a << '\t' << shard.anchor.b;
+	return out.str();
+}
+
+inline ComparisonShard parse_shard(std::string_view line)
+{
+	std::vector<std::string> fields;
+	std::size_t start = 0;
+	while (true)
+	{
+		auto tab = line.find('\t', start);
+		fields.emplace_back(line.substr(start, tab == std::string_view::npos ? std::string_view::npos : tab - start));
+		if (tab == std::string_view::npos)
+			break;
+		start = tab + 1;
+	}
+	if (fields.size() != 9)
+		throw std::invalid_argument("comparison shard must have 9 tab separated fields");
+
+	auto number = [](const std::string& field) {
+		std::size_t used = 0;
+		auto value = std::stoull(field, &used);
+		if (used != field.size())
+			throw std::invalid_argument("comparison shard field is not a number: " + field);
+		return static_cast<std::size_t>(value);
+	};
+
+	return {
+		fields[0], fields[1], number(fields[2]),
+		{ number(fields[3]), number(fields[4]) },
+		{ number(fields[5]), number(fields[6]) },
+		{ number(fields[7]), number(fields[8]) }
+	};
+}
+
+/*
+ * One line per difference: chromosome, range in a, range in b and kind.
+ */
+inline std::string serialize(const partial_diffs& partial)
+{
+	std::ostringstream out;
+	for (const auto& diff : partial.diffs)
+	{
+		out << diff.chromosome << '\t' << diff.a.first << '\t' << diff.a.last << '\t'
+				<< diff.b.first << '\t' << diff.b.last << '\t' << static_cast<int>(diff.kind) << '\n';
+	}
+	return out.str();
+}
+
+inline partial_diffs parse_partial(std::string_view text)
+{
+	partial_diffs partial;
+	std::istringstream in{ std::string(text) };
+	std::string line;
+	while (std::getline(in, line))
+	{
+		if (line.empty())
+			continue;
+
+		std::istringstream fields(line);
+		difference diff;
+		int kind;
+		if (!(fields >> diff.chromosome >> diff.a.first >> diff.a.last >> diff.b.first >> diff.b.last >> kind))
+			throw std::invalid_argument("malformed difference: " + line);
+		if (kind < static_cast<int>(difference_kind::substitution) || kind > static_cast<int>(difference_kind::deletion))
+			throw std::runtime_error("unknown difference kind: " + line);
+		diff.kind = static_cast<difference_kind>(kind);
+		partial.diffs.push_back(diff);
+	}
+	return partial;
+}
+
+/*
+ * Compares the bases of one shard.
+ */
+inline partial_diffs map(const ComparisonShard& shard, const Person& a, const Person& b)
+{
+	const auto& ca = a.chromosome(shard.chromosome);
+	const auto& cb = b.chromosome(shard.chromosome);
+	auto sa = ca.read_at(0, static_cast<std::size_t>(ca.size()));
+	auto sb = cb.read_at(0, static_cast<std::size_t>(cb.size()));
+
+	auto ra = shard.range_a;
+	auto rb = shard.range_b;
+	if (ra.last > sa.size() || rb.last > sb.size() || ra.first > ra.last || rb.first > rb.last)
+		throw std::invalid_argument("comparison shard does not fit the chromosome");
+
+	// indels in earlier shards may have moved this one off its diagonal. If it
+	// starts out of step, walk in from up to a Kbase ahead of range_a on the
+	// diagonal found there, and keep only what lies within range_a.
+	bool carries_tails = ra.size() != rb.size();
+	auto walk_a = ra;
+	auto walk_b = rb;
+	if (ra.first != shard.anchor.a && ra.size() != 0 && rb.size() != 0 &&
+			detail::mismatch_cluster(sa, ra.first, sb, rb.first, std::min(ra.size(), rb.size())))
+	{
+		auto back = std::min(ra.first - shard.anchor.a, detail::resync_window_bases);
+		walk_a.first = ra.first - back;
+		walk_b.first = resync(sa, walk_a, sb, { rb.first - std::min(rb.first, back), sb.size() });
+	}
+
+	// every base of range_a is compared, even if an indel in this shard shifts b
+	if (!carries_tails)
+		walk_b.last = std::min(walk_b.first + walk_a.size() + detail::resync_slack_bases, sb.size());
+	walk_b.first = std::min(walk_b.first, walk_b.last);
+
+	auto aligned = align_packed(sa, walk_a, sb, walk_b, shard.chromosome);
+	partial_diffs partial;
+	for (auto diff : aligned.diffs)
+	{
+		if (diff.a.last < ra.first || (diff.a.last == ra.first && diff.a.first < ra.first))
+			continue;
+		if (diff.a.first < ra.first)
+		{
+			if (diff.kind == difference_kind::substitution)
+				diff.b.first += ra.first - diff.a.first;
+			diff.a.first = ra.first;
+		}
+		partial.diffs.push_back(diff);
+	}
+
+	if (carries_tails && (aligned.a_end != ra.last || aligned.b_end != walk_b.last))
+	{
+		partial.diffs.push_back({ shard.chromosome,
+				{ aligned.a_end, ra.last },
+				{ aligned.b_end, walk_b.last },
+				difference_kind::unmatched });
+	}
+	return partial;
+}
+
+namespace detail
+{
+
+inline bool diff_order(const difference& x, const difference& y)
+{
+	return std::tie(x.chromosome, x.a.first, x.b.first, x.kind) < std::tie(y.chromosome, y.a.first, y.b.first, y.kind);
+}
+
+/*
+ * Whether `next` continues `prev`: a run of differences that was cut in two
+ * by a shard border, or the same run found by two overlapping shards.
+ */
+inline bool continues(const difference& prev, const difference& next)
+{
+	return prev.chromosome == next.chromosome && prev.kind == next.kind &&
+			next.a.first <= prev.a.last && next.b.first <= prev.b.last &&
+			next.a.first - prev.a.first == next.b.first - prev.b.first;
+}
+
+}
+
+/*
+ * Combines the results of two sets of shards. Associative and commutative, so
+ * partials can be reduced in any grouping and order: differences are merged
+ * by position and runs that meet or overlap at shard borders are joined.
+ */
+inline partial_diffs reduce(const partial_diffs& x, const partial_diffs& y)
+{
+	std::vector<difference> merged;
+	merged.reserve(x.diffs.size() + y.diffs.size());
+	std::merge(x.diffs.begin(), x.diffs.end(), y.diffs.begin(), y.diffs.end(), std::back_inserter(merged), detail::diff_order);
+
+	partial_diffs result;
+	for (const auto& diff : merged)
+	{
+		if (!result.diffs.empty() && detail::continues(result.diffs.back(), diff))
+		{
+			auto& prev = result.diffs.back();
+			prev.a.last = std::max(prev.a.last, diff.a.last);
+			prev.b.last = std::max(prev.b.last, diff.b.last);
+			continue;
+		}
+		result.diffs.push_back(diff);
+	}
+	return result;
+}
+
+}
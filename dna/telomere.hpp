@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include "base.hpp"
+#include "packed_compare.hpp"
+#include "sequence_buffer.hpp"
+
+namespace dna
+{
+
+/*
+ * The telomere at one end of a chromosome: `partial` bases of the repeat the
+ * sequencer cut into at the outer end (0..5), followed (or preceded, at the
+ * end) by `repeats` complete TTAGGG repeats. `length` is the total number of
+ * telomere bases. An end without a complete repeat has no telomere.
+ */
+struct telomere_run
+{
+	std::size_t length;
+	std::size_t repeats;
+	std::size_t partial;
+
+	constexpr bool operator==(const telomere_run& other) const noexcept
+	{
+		return length == other.length && repeats == other.repeats && partial == other.partial;
+	}
+};
+
+namespace detail
+{
+
+constexpr std::size_t telomere_period = 6;
+
+/*
+ * 32 bases of TTAGGGTTAGGG... starting at every phase of the repeat.
+ * The repeat is 12 bits long, so byte aligned words only ever see three of
+ * these phases: 32 bases advance the phase by 2.
+ */
+constexpr std::array<packed_word, telomere_period> make_telomere_words()
+{
+	std::array<packed_word, telomere_period> words{};
+	for (std::size_t phase = 0; phase < words.size(); ++phase)
+	{
+		for (std::size_t i = 0; i < word_bases; ++i)
+		{
+			auto b = static_cast<packed_word>(telo[(phase + i) % telomere_period]);
+			words[phase] |= b << (62 - 2 * i);
+		}
+	}
+	return words;
+}
+
+inline constexpr std::array<packed_word, telomere_period> telomere_words = make_telomere_words();
+
+/*
+ * Offset (0..31) of the last base set in a differing_bases() word.
+ */
+inline std::size_t last_base(packed_word bits)
+{
+	return word_bases - 1 - static_cast<std::size_t>(__builtin_ctzll(bits)) / 2;
+}
+
+inline telomere_run make_run(std::size_t bases, std::size_t partial)
+{
+	auto repeats = (bases - partial) / telomere_period;
+	if (repeats == 0)
+		return { 0, 0, 0 };
+	return { partial + repeats * telomere_period, repeats, partial };
+}
+
+}
+
+/*
+ * The telomere at the start of a sequence. The bases are compared a word at a
+ * time against the repeat, so the run is measured exactly, up to the first
+ * base that breaks it, without unpacking any bases.
+ */
+template<class S>
+telomere_run telomere_run_begin(const S& seq)
+{
+	using detail::telomere_period;
+	using detail::telomere_words;
+
+	auto size = seq.size();
+
+	// the leading partial repeat decides the phase; only one can match a whole repeat after it
+	std::size_t partial = 0;
+	for (; partial < telomere_period; ++partial)
+	{
+		auto bases = partial + telomere_period;
+		auto phase = (telomere_period - partial) % telomere_period;
+		if (bases <= size && ((seq.word_at(0) ^ telomere_words[phase]) & word_mask(bases)) == 0)
+			break;
+	}
+	if (partial == telomere_period)
+		return { 0, 0, 0 };
+
+	auto phase = (telomere_period - partial) % telomere_period;
+	auto run = size;
+	for (std::size_t pos = 0; pos < size; pos += word_bases)
+	{
+		auto diff = (seq.word_at(pos) ^ telomere_words[(phase + pos) % telomere_period]) & word_mask(size - pos);
+		if (diff != 0)
+		{
+			run = pos + detail::first_base(detail::differing_bases(diff));
+			break;
+		}
+	}
+	return detail::make_run(run, partial);
+}
+
+/*
+ * The telomere at the end of a sequence, scanned backwards a word at a time.
+ */
+template<class S>
+telomere_run telomere_run_end(const S& seq)
+{
+	using detail::telomere_period;
+	using detail::telomere_words;
+
+	auto size = seq.size();
+
+	// a whole repeat ends where the trailing partial repeat starts, so it is always phase 0
+	std::size_t partial = 0;
+	for (; partial < telomere_period; ++partial)
+	{
+		auto bases = partial + telomere_period;
+		if (bases <= size && ((seq.word_at(size - bases) ^ telomere_words[0]) & word_mask(bases)) == 0)
+			break;
+	}
+	if (partial == telomere_period)
+		return { 0, 0, 0 };
+
+	// phase of position p is (p - repeat_start) mod 6, for any repeat start
+	auto repeat_start = (size - partial) % telomere_period;
+	auto run = size;
+	for (auto end = size; end > 0; )
+	{
+		auto pos = end > word_bases ? end - word_bases : 0;
+		auto count = end - pos;
+		auto phase = (pos % telomere_period + telomere_period - repeat_start) % telomere_period;
+
+		auto diff = (seq.word_at(pos) ^ telomere_words[phase]) & word_mask(count);
+		if (diff != 0)
+		{
+			run = size - (pos + detail::last_base(detail::differing_bases(diff)) + 1);
+			break;
+		}
+		end = pos;
+	}
+	return detail::make_run(run, partial);
+}
+
+/*
+ * Where the real bases of a chromosome are once the telomeres are cut off
+ * both ends, and the telomeres that were cut.
+ */
+struct chromosome_trim
+{
+	base_range bounds;
+	telomere_run head;
+	telomere_run tail;
+
+	constexpr bool operator==(const chromosome_trim& other) const noexcept
+	{
+		return bounds == other.bounds && head == other.head && tail == other.tail;
+	}
+};
+
+/*
+ * Combines the telomeres found at both ends of a chromosome of `size` bases.
+ * A chromosome that is telomere from end to end has empty bounds.
+ */
+inline chromosome_trim make_trim(std::size_t size, const telomere_run& head, const telomere_run& tail)
+{
+	auto first = std::min(head.length, size);
+	auto last = size - std::min(tail.length, size - first);
+	return { { first, last }, head, tail };
+}
+
+using trim_table = std::array<chromosome_trim, 23>;
+
+template<class S>
+chromosome_trim trim_telomeres(const S& seq)
+{
+	return make_trim(seq.size(), telomere_run_begin(seq), telomere_run_end(seq));
+}
+
+}
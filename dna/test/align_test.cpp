@@ -0,0 +1,226 @@
+#include "catch.hpp"
+#include <algorithm>
+#include <vector>
+#include "align.hpp"
+#include "genome_builder.hpp"
+
+namespace
+{
+
+/*
+ * Packs any number of bases, padding the last byte with A.
+ */
+std::vector<std::byte> pack_bases(std::vector<dna::base> bases)
+{
+	bases.resize((bases.size() + 3) / 4 * 4, dna::A);
+	genome_builder builder;
+	builder.append(bases);
+	return builder.packed();
+}
+
+std::vector<dna::base> random_bases(std::size_t count, unsigned seed)
+{
+	genome_builder builder;
+	builder.body(count, seed);
+	return builder.bases();
+}
+
+}
+
+TEST_CASE("Window alignment finds a single insertion", "[align]")
+{
+	auto a_bases = random_bases(200, 3);
+	auto b_bases = a_bases;
+	b_bases.insert(b_bases.begin() + 50, { dna::G, dna::G, dna::T });
+	auto pa = pack_bases(a_bases);
+	auto pb = pack_bases(b_bases);
+	dna::sequence_buffer a(pa, a_bases.size());
+	dna::sequence_buffer b(pb, b_bases.size());
+
+	auto path = dna::align_window(a, 0, a.size(), b, 0, b.size());
+	REQUIRE(path.cost == 3);
+	REQUIRE(path.a_bases == 200);
+	REQUIRE(path.b_bases == 203);
+
+	std::size_t inserts = 0;
+	for (auto op : path.ops)
+		inserts += op == dna::edit_op::insert;
+	REQUIRE(inserts == 3);
+}
+
+TEST_CASE("Window alignment costs match a plain edit distance table", "[align]")
+{
+	// several blocks of 64 bases of a, with edits of every kind
+	auto a_bases = random_bases(300, 21);
+	auto b_bases = a_bases;
+	b_bases[250] = substitute(b_bases[250]);
+	b_bases.erase(b_bases.begin() + 190, b_bases.begin() + 196);
+	b_bases.insert(b_bases.begin() + 130, 9, dna::C);
+	b_bases[64] = substitute(b_bases[64]);
+	b_bases.erase(b_bases.begin() + 20);
+	auto pa = pack_bases(a_bases);
+	auto pb = pack_bases(b_bases);
+	dna::sequence_buffer a(pa, a_bases.size());
+	dna::sequence_buffer b(pb, b_bases.size());
+
+	for (std::size_t la : { std::size_t{0}, std::size_t{63}, std::size_t{64}, std::size_t{200}, a.size() })
+	{
+		INFO("la " << la);
+		auto lb = b.size();
+		std::vector<std::vector<std::size_t>> table(la + 1, std::vector<std::size_t>(lb + 1));
+		for (std::size_t i = 0; i <= la; i++)
+		{
+			for (std::size_t j = 0; j <= lb; j++)
+			{
+				if (i == 0 || j == 0)
+					table[i][j] = i + j;
+				else
+					table[i][j] = std::min({ table[i - 1][j - 1] + (a_bases[i - 1] != b_bases[j - 1]),
+							table[i - 1][j] + 1, table[i][j - 1] + 1 });
+			}
+		}
+		std::size_t best = table[la][0];
+		for (std::size_t j = 0; j <= lb; j++)
+			best = std::min(best, table[la][j]);
+		for (std::size_t i = 0; i <= la; i++)
+			best = std::min(best, table[i][lb]);
+
+		auto path = dna::align_window(a, 0, la, b, 0, lb);
+		REQUIRE(path.cost == best);
+		REQUIRE(path.cost == table[path.a_bases][path.b_bases]);
+
+		// the path spells out its cost
+		std::size_t edits = 0, a_walked = 0, b_walked = 0;
+		for (auto op : path.ops)
+		{
+			edits += op != dna::edit_op::match;
+			a_walked += op != dna::edit_op::insert;
+			b_walked += op != dna::edit_op::remove;
+		}
+		REQUIRE(edits == path.cost);
+		REQUIRE(a_walked == path.a_bases);
+		REQUIRE(b_walked == path.b_bases);
+	}
+}
+
+TEST_CASE("Positional differences are unchanged without indels", "[align]")
+{
+	auto a_bases = random_bases(1000, 5);
+	auto b_bases = a_bases;
+	for (std::size_t p : { 10, 11, 12, 400, 999 })
+		b_bases[p] = substitute(b_bases[p]);
+	auto pa = pack_bases(a_bases);
+	auto pb = pack_bases(b_bases);
+	dna::sequence_buffer a(pa, 1000);
+	dna::sequence_buffer b(pb, 1000);
+
+	auto aligned = dna::align_packed(a, { 0, 1000 }, b, { 0, 1000 }, 4);
+	std::vector<dna::difference> expected = {
+			{ 4, { 10, 13 }, { 10, 13 }, dna::difference_kind::substitution },
+			{ 4, { 400, 401 }, { 400, 401 }, dna::difference_kind::substitution },
+			{ 4, { 999, 1000 }, { 999, 1000 }, dna::difference_kind::substitution } };
+	REQUIRE(aligned.diffs == expected);
+	REQUIRE(aligned.a_end == 1000);
+	REQUIRE(aligned.b_end == 1000);
+}
+
+TEST_CASE("Insertions and deletions are reported and the diagonal is picked up again", "[align]")
+{
+	auto a_bases = random_bases(5000, 7);
+	auto b_bases = a_bases;
+	// positions in a, applied back to front so earlier positions stay put
+	b_bases[4000] = substitute(b_bases[4000]);
+	b_bases.erase(b_bases.begin() + 3000, b_bases.begin() + 3017);
+	b_bases[1210] = substitute(b_bases[1210]);
+	b_bases.insert(b_bases.begin() + 1200, 5, dna::A);
+	b_bases[100] = substitute(b_bases[100]);
+	auto pa = pack_bases(a_bases);
+	auto pb = pack_bases(b_bases);
+	dna::sequence_buffer a(pa, a_bases.size());
+	dna::sequence_buffer b(pb, b_bases.size());
+
+	auto aligned = dna::align_packed(a, { 0, a.size() }, b, { 0, b.size() });
+	REQUIRE(aligned.diffs.size() == 5);
+
+	REQUIRE(aligned.diffs[0] == dna::difference{ 0, { 100, 101 }, { 100, 101 }, dna::difference_kind::substitution });
+
+	// the five inserted As may sit anywhere along a run of As around 1200
+	auto insertion = aligned.diffs[1];
+	REQUIRE(insertion.kind == dna::difference_kind::insertion);
+	REQUIRE(insertion.a.size() == 0);
+	REQUIRE(insertion.b.size() == 5);
+	REQUIRE(insertion.b.first - insertion.a.first == 0);
+	REQUIRE(insertion.a.first <= 1200);
+
+	REQUIRE(aligned.diffs[2] == dna::difference{ 0, { 1210, 1211 }, { 1215, 1216 }, dna::difference_kind::substitution });
+
+	// 17 bases of a missing from b, give or take a base of slack in a repeat
+	auto deletion = aligned.diffs[3];
+	REQUIRE(deletion.kind == dna::difference_kind::deletion);
+	REQUIRE(deletion.a.size() == 17);
+	REQUIRE(deletion.b.size() == 0);
+	REQUIRE(deletion.a.first <= 3000);
+	REQUIRE(deletion.b.first == deletion.a.first + 5);
+
+	REQUIRE(aligned.diffs[4] == dna::difference{ 0, { 4000, 4001 }, { 3988, 3989 }, dna::difference_kind::substitution });
+	REQUIRE(aligned.a_end == a.size());
+	REQUIRE(aligned.b_end == b.size());
+}
+
+TEST_CASE("Unrelated sequences are not explained by indels", "[align]")
+{
+	auto a_bases = random_bases(600, 11);
+	auto b_bases = a_bases;
+	auto noise = random_bases(200, 12);
+	std::copy(noise.begin(), noise.end(), b_bases.begin() + 200);
+	auto pa = pack_bases(a_bases);
+	auto pb = pack_bases(b_bases);
+	dna::sequence_buffer a(pa, 600);
+	dna::sequence_buffer b(pb, 600);
+
+	auto aligned = dna::align_packed(a, { 0, 600 }, b, { 0, 600 });
+	for (const auto& diff : aligned.diffs)
+	{
+		REQUIRE(diff.kind == dna::difference_kind::substitution);
+		REQUIRE(diff.a == diff.b);
+		REQUIRE(diff.a.first >= 200);
+		REQUIRE(diff.a.last <= 400);
+	}
+}
+
+TEST_CASE("Indels longer than an alignment window are found by seeding ahead", "[align]")
+{
+	auto a_bases = random_bases(30'000, 13);
+	auto b_bases = a_bases;
+	// positions in a, applied back to front so earlier positions stay put
+	b_bases[25'000] = substitute(b_bases[25'000]);
+	b_bases.erase(b_bases.begin() + 18'000, b_bases.begin() + 18'300);
+	auto inserted = random_bases(150, 14);
+	b_bases.insert(b_bases.begin() + 9'000, inserted.begin(), inserted.end());
+	auto pa = pack_bases(a_bases);
+	auto pb = pack_bases(b_bases);
+	dna::sequence_buffer a(pa, a_bases.size());
+	dna::sequence_buffer b(pb, b_bases.size());
+
+	auto aligned = dna::align_packed(a, { 0, a.size() }, b, { 0, b.size() }, 2);
+	REQUIRE(aligned.diffs.size() == 3);
+
+	// the inserted bases may match the bases after them for a few bases
+	auto insertion = aligned.diffs[0];
+	REQUIRE(insertion.kind == dna::difference_kind::insertion);
+	REQUIRE(insertion.b.size() == 150);
+	REQUIRE(insertion.a.first >= 9'000);
+	REQUIRE(insertion.a.first <= 9'010);
+	REQUIRE(insertion.b.first == insertion.a.first);
+
+	auto deletion = aligned.diffs[1];
+	REQUIRE(deletion.kind == dna::difference_kind::deletion);
+	REQUIRE(deletion.a.size() == 300);
+	REQUIRE(deletion.a.first >= 18'000);
+	REQUIRE(deletion.a.first <= 18'010);
+	REQUIRE(deletion.b.first == deletion.a.first + 150);
+
+	REQUIRE(aligned.diffs[2] == dna::difference{ 2, { 25'000, 25'001 }, { 24'850, 24'851 }, dna::difference_kind::substitution });
+	REQUIRE(aligned.a_end == a.size());
+	REQUIRE(aligned.b_end == b.size());
+}
@@ -0,0 +1,73 @@
+#include "allocation_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic<bool> counting{false};
+std::atomic<std::size_t> allocation_count{0};
+std::atomic<std::size_t> allocated_bytes{0};
+std::atomic<std::size_t> largest_allocation{0};
+
+void record(std::size_t size)
+{
+	if (!counting.load(std::memory_order_relaxed))
+		return;
+
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+	auto largest = largest_allocation.load(std::memory_order_relaxed);
+	while (size > largest && !largest_allocation.compare_exchange_weak(largest, size, std::memory_order_relaxed))
+		;
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+	record(size);
+	if (void* p = std::malloc(size == 0 ? 1 : size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+allocation_counter::allocation_counter()
+{
+	allocation_count = 0;
+	allocated_bytes = 0;
+	largest_allocation = 0;
+	counting = true;
+}
+
+allocation_counter::~allocation_counter()
+{
+	counting = false;
+}
+
+std::size_t allocation_counter::allocations() const
+{
+	return allocation_count.load();
+}
+
+std::size_t allocation_counter::bytes() const
+{
+	return allocated_bytes.load();
+}
+
+std::size_t allocation_counter::largest() const
+{
+	return largest_allocation.load();
+}
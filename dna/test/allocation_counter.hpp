@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Counts what global operator new hands out while an instance is alive.
+ * Only one counter may be active at a time.
+ */
+class allocation_counter
+{
+public:
+	allocation_counter();
+	~allocation_counter();
+
+	allocation_counter(const allocation_counter&) = delete;
+	allocation_counter& operator=(const allocation_counter&) = delete;
+
+	std::size_t allocations() const;
+	std::size_t bytes() const;
+	std::size_t largest() const;
+};
@@ -0,0 +1,34 @@
+#include "catch.hpp"
+#include <vector>
+#include "base.hpp"
+
+TEST_CASE("Unpack table matches unpack for every byte", "[base]")
+{
+	for (int i = 0; i < 256; i++)
+	{
+		auto b = static_cast<std::byte>(i);
+		REQUIRE(dna::unpack_table[i] == dna::unpack(b));
+		for (std::size_t j = 0; j < 4; j++)
+			REQUIRE(dna::unpack_at(b, j) == dna::unpack(b)[j]);
+	}
+}
+
+TEST_CASE("Can bulk unpack a range of bytes", "[base]")
+{
+	// 77 bytes is not a multiple of any SIMD width, so the table tail is exercised too
+	std::vector<std::byte> data(77);
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<std::byte>((i * 151 + 7) & 0xff);
+
+	std::vector<dna::base> bases(data.size() * 4);
+	dna::unpack_range(data.data(), data.size(), bases.data());
+
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		auto expected = dna::unpack(data[i]);
+		REQUIRE(bases[i * 4] == expected[0]);
+		REQUIRE(bases[i * 4 + 1] == expected[1]);
+		REQUIRE(bases[i * 4 + 2] == expected[2]);
+		REQUIRE(bases[i * 4 + 3] == expected[3]);
+	}
+}
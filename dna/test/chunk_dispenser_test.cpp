@@ -0,0 +1,102 @@
+#include "catch.hpp"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "chunk_dispenser.hpp"
+#include "kmer.hpp"
+#include "genome_builder.hpp"
+
+namespace
+{
+
+dna::HelixStream make_stream(std::size_t bases, unsigned seed)
+{
+	genome_builder builder;
+	builder.body(bases, seed);
+	return dna::HelixStream(builder.packed(), 512);
+}
+
+}
+
+TEST_CASE("Chunks cover the chromosome in order", "[chunk_dispenser]")
+{
+	auto stream = make_stream(1000, 1);
+	auto seq = stream.read_at(0, static_cast<std::size_t>(stream.size()));
+	dna::chunk_dispenser chunks(stream, 150);
+
+	REQUIRE(chunks.chunk_bases() == 152);
+	REQUIRE(chunks.size() == 7);
+
+	std::size_t expected = 0;
+	while (auto c = chunks.next())
+	{
+		REQUIRE(c->index == expected);
+		REQUIRE(c->base_offset == expected * 152);
+		REQUIRE(c->view.size() == std::min<std::size_t>(152, 1000 - c->base_offset));
+		REQUIRE(c->view.first_base() == c->base_offset);
+		for (std::size_t i = 0; i < c->view.size(); ++i)
+			REQUIRE(c->view[i] == seq[c->base_offset + i]);
+		++expected;
+	}
+	REQUIRE(expected == 7);
+	REQUIRE_FALSE(chunks.next());
+
+	chunks.reset();
+	REQUIRE(chunks.next()->index == 0);
+}
+
+TEST_CASE("Overlapping chunks see every k-mer exactly once", "[chunk_dispenser]")
+{
+	constexpr std::size_t k = 20;
+	auto stream = make_stream(4000, 2);
+	auto seq = stream.read_at(0, static_cast<std::size_t>(stream.size()));
+	dna::chunk_dispenser chunks(stream, 256, k - 1);
+
+	std::vector<dna::kmer> seen;
+	while (auto c = chunks.next())
+	{
+		// k-mers starting in this chunk; the overlap only completes them
+		auto starts = std::min(chunks.chunk_bases(), c->view.size());
+		for (std::size_t i = 0; i < starts && i + k <= c->view.size(); ++i)
+			seen.push_back(dna::kmer_at(c->view, i, k));
+	}
+
+	std::vector<dna::kmer> expected;
+	for (std::size_t i = 0; i + k <= seq.size(); ++i)
+		expected.push_back(dna::kmer_at(seq, i, k));
+	REQUIRE(seen == expected);
+}
+
+TEST_CASE("Threads take every chunk exactly once", "[chunk_dispenser]")
+{
+	auto stream = make_stream(100'000, 3);
+	dna::chunk_dispenser chunks(stream, 100);
+
+	std::mutex mutex;
+	std::vector<std::size_t> taken;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([&]() {
+			std::vector<std::size_t> mine;
+			while (auto c = chunks.next())
+				mine.push_back(c->index);
+			std::lock_guard<std::mutex> lock(mutex);
+			taken.insert(taken.end(), mine.begin(), mine.end());
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	std::sort(taken.begin(), taken.end());
+	REQUIRE(taken.size() == chunks.size());
+	for (std::size_t i = 0; i < taken.size(); ++i)
+		REQUIRE(taken[i] == i);
+}
+
+TEST_CASE("Chunks must not be empty", "[chunk_dispenser]")
+{
+	auto stream = make_stream(100, 4);
+	REQUIRE_THROWS_AS(dna::chunk_dispenser(stream, 0), std::invalid_argument);
+}
@@ -0,0 +1,299 @@
+#include "catch.hpp"
+#include <array>
+#include <vector>
+#include "compare.hpp"
+#include "genome_builder.hpp"
+
+namespace
+{
+
+/*
+ * Chromosome `index` of a family: the same body for everyone, surrounded by
+ * telomeres of a per person length. Head and tail lengths are chosen so the
+ * chromosome fills whole bytes.
+ */
+genome_builder chromosome(std::size_t index, std::size_t head_repeats, std::size_t head_partial, std::size_t body)
+{
+	genome_builder builder;
+	builder.head_telomere(head_repeats, head_partial).body(body, static_cast<unsigned>(index + 1));
+	auto used = builder.size() % 4;
+	builder.tail_telomere(50, (4 - used + 2) % 4 + 2);
+	return builder;
+}
+
+}
+
+TEST_CASE("Identical people have no differences", "[compare]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = chromosome(i, 100, 2, 4000).packed();
+
+	dna::Person a(data);
+	dna::Person b(data);
+	dna::work_stealing_pool pool(2);
+
+	REQUIRE(dna::compare(a, b, pool).empty());
+}
+
+TEST_CASE("Differences are found after trimming different telomeres", "[compare]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	std::vector<dna::difference> expected;
+
+	for (std::size_t i = 0; i < a_data.size(); i++)
+	{
+		auto a = chromosome(i, 100, 2, 4000);
+		a_data[i] = a.packed();
+
+		// b lost a different number of telomere bases, and has SNPs at 10, 11 and 2000 of the body
+		std::size_t b_head = 80 * 6 + 5;
+		auto b = chromosome(i, 80, 5, 4000);
+		for (std::size_t p : { 10, 11, 2000 })
+			b.bases()[b_head + p] = substitute(b.bases()[b_head + p]);
+		b_data[i] = b.packed();
+
+		std::size_t a_head = 100 * 6 + 2;
+		expected.push_back({ i, { a_head + 10, a_head + 12 }, { b_head + 10, b_head + 12 }, dna::difference_kind::substitution });
+		expected.push_back({ i, { a_head + 2000, a_head + 2001 }, { b_head + 2000, b_head + 2001 }, dna::difference_kind::substitution });
+	}
+
+	dna::Person a(a_data);
+	dna::Person b(b_data);
+	dna::work_stealing_pool pool(2);
+
+	REQUIRE(dna::compare(a, b, pool) == expected);
+}
+
+TEST_CASE("Extra bases on one side are unmatched", "[compare]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	for (std::size_t i = 0; i < a_data.size(); i++)
+		a_data[i] = b_data[i] = chromosome(i, 100, 2, 4000).packed();
+
+	// the sequencer lost the end of b's chromosome 5, tail telomere and all
+	auto shortened = chromosome(4, 100, 2, 4000);
+	shortened.bases().resize(100 * 6 + 2 + 3002);
+	b_data[4] = shortened.packed();
+
+	dna::Person a(a_data);
+	dna::Person b(b_data);
+	dna::work_stealing_pool pool(2);
+
+	auto diffs = dna::compare(a, b, pool);
+	REQUIRE(diffs.size() == 1);
+	REQUIRE(diffs[0].chromosome == 4);
+	REQUIRE(diffs[0].kind == dna::difference_kind::unmatched);
+	REQUIRE(diffs[0].a.first == 100 * 6 + 2 + 3002);
+	REQUIRE(diffs[0].a.last == 100 * 6 + 2 + 4000);
+	REQUIRE(diffs[0].b.size() == 0);
+}
+
+TEST_CASE("An insertion longer than an alignment window is found within a shard", "[compare]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	for (std::size_t i = 0; i < a_data.size(); i++)
+		a_data[i] = b_data[i] = chromosome(i, 100, 2, 20'000).packed();
+
+	// 120 bases inserted at body position 10000, in the middle of the second of three shards
+	std::size_t head = 100 * 6 + 2;
+	auto b = chromosome(6, 100, 2, 20'000);
+	genome_builder noise;
+	noise.body(120, 99);
+	b.bases().insert(b.bases().begin() + static_cast<long>(head + 10'000), noise.bases().begin(), noise.bases().end());
+	b_data[6] = b.packed();
+
+	dna::Person pa(a_data);
+	dna::Person pb(b_data);
+	dna::work_stealing_pool pool(2);
+	auto shards = dna::plan_shards(pa, pb, "a", "b", 8000, pool);
+	auto diffs = dna::run_local(shards, pa, pb, pool).diffs;
+
+	REQUIRE(diffs.size() == 1);
+	REQUIRE(diffs[0].chromosome == 6);
+	REQUIRE(diffs[0].kind == dna::difference_kind::insertion);
+	REQUIRE(diffs[0].b.size() == 120);
+	REQUIRE(diffs[0].a.first >= head + 10'000);
+	REQUIRE(diffs[0].a.first <= head + 10'010);
+}
+
+TEST_CASE("Chromosome 23 is skipped for an X and a Y", "[compare]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	for (std::size_t i = 0; i < 22; i++)
+		a_data[i] = b_data[i] = chromosome(i, 100, 2, 4000).packed();
+
+	a_data[22] = std::vector<std::byte>(dna::sex_classifier{}.y_max_bases / 4 + 1000);
+	// long enough to be a Y by its length alone
+	b_data[22] = std::vector<std::byte>(dna::sex_classifier{}.y_min_bases / 4 + 1000, std::byte{0x1b});
+
+	dna::Person a(a_data);
+	dna::Person b(b_data);
+	dna::work_stealing_pool pool(2);
+
+	REQUIRE(dna::compare(a, b, pool).empty());
+}
+
+TEST_CASE("A region is compared against every member of a cohort", "[compare][region]")
+{
+	std::array<std::vector<std::byte>, 23> source_data;
+	for (std::size_t i = 0; i < source_data.size(); i++)
+		source_data[i] = chromosome(i, 100, 2, 4000).packed();
+
+	// same genome, shorter head telomeres and an SNP at body position 1520
+	std::array<std::vector<std::byte>, 23> snp_data = source_data;
+	auto snp = chromosome(7, 80, 5, 4000);
+	std::size_t snp_head = 80 * 6 + 5;
+	snp.bases()[snp_head + 1520] = substitute(snp.bases()[snp_head + 1520]);
+	snp_data[7] = snp.packed();
+
+	// 40 bases inserted at body position 200, ahead of the region
+	std::array<std::vector<std::byte>, 23> shifted_data = source_data;
+	auto shifted = chromosome(7, 100, 2, 4000);
+	std::size_t shifted_head = 100 * 6 + 2;
+	shifted.bases().insert(shifted.bases().begin() + static_cast<long>(shifted_head + 200), 40, dna::C);
+	shifted_data[7] = shifted.packed();
+
+	// a chromosome 8 the region doesn't occur in
+	std::array<std::vector<std::byte>, 23> other_data = source_data;
+	other_data[7] = chromosome(99, 100, 2, 4000).packed();
+
+	dna::Person source(source_data);
+	dna::Person same(source_data);
+	dna::Person with_snp(snp_data);
+	dna::Person with_insert(shifted_data);
+	dna::Person unrelated(other_data);
+	std::vector<const dna::Person*> cohort = { &same, &with_snp, &with_insert, &unrelated };
+	dna::work_stealing_pool pool(2);
+
+	std::size_t head = 100 * 6 + 2;
+	dna::base_range region{ head + 1000, head + 2000 };
+	auto matches = dna::compare_region(source, 7, region, cohort, pool);
+	REQUIRE(matches.size() == 4);
+
+	REQUIRE(matches[0].anchored);
+	REQUIRE(matches[0].range == region);
+	REQUIRE(matches[0].diffs.empty());
+
+	REQUIRE(matches[1].anchored);
+	REQUIRE(matches[1].range == dna::base_range{ snp_head + 1000, snp_head + 2000 });
+	REQUIRE(matches[1].diffs == std::vector<dna::difference>{
+			{ 7, { head + 1520, head + 1521 }, { snp_head + 1520, snp_head + 1521 }, dna::difference_kind::substitution } });
+
+	REQUIRE(matches[2].anchored);
+	REQUIRE(matches[2].range == dna::base_range{ head + 1040, head + 2040 });
+	REQUIRE(matches[2].diffs.empty());
+
+	REQUIRE_FALSE(matches[3].anchored);
+}
+
+TEST_CASE("Region comparison rejects bad arguments", "[compare][region]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = chromosome(i, 100, 2, 4000).packed();
+	dna::Person source(data);
+	dna::work_stealing_pool pool(1);
+
+	std::vector<const dna::Person*> cohort = { &source, nullptr };
+	REQUIRE_THROWS_AS(dna::compare_region(source, 0, { 10, 20 }, cohort, pool), std::invalid_argument);
+
+	cohort.pop_back();
+	REQUIRE_THROWS_AS(dna::compare_region(source, 0, { 10, 100000 }, cohort, pool), std::invalid_argument);
+	REQUIRE(dna::compare_region(source, 0, { 10, 10 }, cohort, pool).front().diffs.empty());
+}
+
+TEST_CASE("Seeds line up chromosomes without a head telomere", "[compare][anchor]")
+{
+	auto a = chromosome(3, 100, 2, 4000);
+	std::size_t a_head = 100 * 6 + 2;
+
+	// b lost its whole head telomere and the first 18 bases of the body
+	genome_builder b;
+	b.append(std::vector<dna::base>(a.bases().begin() + static_cast<long>(a_head + 18), a.bases().end()));
+	auto pa = a.packed();
+	auto pb = b.packed();
+	dna::sequence_buffer sa(pa);
+	dna::sequence_buffer sb(pb);
+
+	auto anchor = dna::find_anchor(sa, { a_head, sa.size() }, sb, { 0, sb.size() });
+	REQUIRE(anchor);
+	REQUIRE(anchor->a == a_head + 18);
+	REQUIRE(anchor->b == 0);
+
+	// and the other way around
+	anchor = dna::find_anchor(sb, { 0, sb.size() }, sa, { a_head, sa.size() });
+	REQUIRE(anchor);
+	REQUIRE(anchor->a == 0);
+	REQUIRE(anchor->b == a_head + 18);
+
+	// unrelated sequences have nothing to line up on
+	auto other = chromosome(50, 100, 2, 4000).packed();
+	dna::sequence_buffer so(other);
+	REQUIRE_FALSE(dna::find_anchor(sa, dna::trim_telomeres(sa).bounds, so, dna::trim_telomeres(so).bounds));
+}
+
+TEST_CASE("Differences are found when a telomere was lost", "[compare][anchor]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	for (std::size_t i = 0; i < a_data.size(); i++)
+		a_data[i] = b_data[i] = chromosome(i, 100, 2, 4000).packed();
+
+	// b's chromosome 10 starts 22 bases into the body and has an SNP at body position 3000
+	std::size_t head = 100 * 6 + 2;
+	auto full = chromosome(9, 100, 2, 4000);
+	genome_builder damaged;
+	damaged.append(std::vector<dna::base>(full.bases().begin() + static_cast<long>(head + 22), full.bases().end()));
+	damaged.bases()[3000 - 22] = substitute(damaged.bases()[3000 - 22]);
+	b_data[9] = damaged.packed();
+
+	dna::Person a(a_data);
+	dna::Person b(b_data);
+	dna::work_stealing_pool pool(2);
+
+	REQUIRE(b.trim_bounds(pool)[9].head.length == 0);
+	std::vector<dna::difference> expected = {
+			{ 9, { head + 3000, head + 3001 }, { 2978, 2979 }, dna::difference_kind::substitution } };
+	REQUIRE(dna::compare(a, b, pool) == expected);
+}
+
+TEST_CASE("An indel doesn't turn the rest of the chromosome into differences", "[compare][align]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	for (std::size_t i = 0; i < a_data.size(); i++)
+		a_data[i] = b_data[i] = chromosome(i, 100, 2, 4000).packed();
+
+	// b has 8 extra bases at body position 1000 of chromosome 3, and an SNP at 3000
+	std::size_t head = 100 * 6 + 2;
+	auto b = chromosome(2, 100, 2, 4000);
+	b.bases()[head + 3000] = substitute(b.bases()[head + 3000]);
+	b.bases().insert(b.bases().begin() + static_cast<long>(head + 1000), { dna::C, dna::A, dna::T, dna::G, dna::C, dna::A, dna::T, dna::G });
+	b_data[2] = b.packed();
+
+	dna::Person pa(a_data);
+	dna::Person pb(b_data);
+	dna::work_stealing_pool pool(2);
+
+	auto whole = dna::compare(pa, pb, pool);
+	REQUIRE(whole.size() == 2);
+	REQUIRE(whole[0].kind == dna::difference_kind::insertion);
+	REQUIRE(whole[0].b.size() == 8);
+	REQUIRE(whole[0].b.first == whole[0].a.first);
+	// where exactly depends on how far the inserted bases repeat their neighbours
+	REQUIRE(whole[0].a.first >= head + 1000);
+	REQUIRE(whole[0].a.first <= head + 1008);
+	REQUIRE(whole[1] == dna::difference{ 2, { head + 3000, head + 3001 }, { head + 3008, head + 3009 }, dna::difference_kind::substitution });
+
+	// shards cut after the insertion have to find the diagonal again
+	for (std::size_t shard_bases : { 500, 333, 1001 })
+	{
+		INFO("shard bases " << shard_bases);
+		REQUIRE(dna::run_local(dna::plan_shards(pa, pb, "a", "b", shard_bases, pool), pa, pb, pool).diffs == whole);
+	}
+}
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "diff_stream.hpp"
+#include "genome_builder.hpp"
+#include "temp_file.hpp"
+
+namespace
+{
+
+std::vector<dna::difference> sample_diffs()
+{
+	return {
+		{ 0, { 10, 12 }, { 10, 12 }, dna::difference_kind::substitution },
+		{ 0, { 5000, 5000 }, { 5000, 5008 }, dna::difference_kind::insertion },
+		{ 0, { 9000, 9001 }, { 9008, 9009 }, dna::difference_kind::substitution },
+		{ 0, { 12000, 12017 }, { 12008, 12008 }, dna::difference_kind::deletion },
+		{ 4, { 3'000'000'000, 3'000'000'001 }, { 7, 8 }, dna::difference_kind::substitution },
+		{ 22, { 600, 4000 }, { 600, 600 }, dna::difference_kind::unmatched },
+	};
+}
+
+}
+
+TEST_CASE("Differences survive a round trip through a stream", "[diffstream]")
+{
+	temp_file file("round_trip");
+	auto diffs = sample_diffs();
+	{
+		dna::diff_writer writer(file.path());
+		writer.append(diffs);
+	}
+
+	dna::diff_reader reader(file.path());
+	REQUIRE(reader.read_all() == diffs);
+	for (const auto& record : reader)
+		REQUIRE(record.alternate.size() == 0);
+}
+
+TEST_CASE("SNP records take a few bytes each", "[diffstream]")
+{
+	std::vector<dna::difference> diffs;
+	for (std::size_t i = 0; i < 10000; i++)
+		diffs.push_back({ 1, { 1000 + i * 100, 1001 + i * 100 }, { 1003 + i * 100, 1004 + i * 100 }, dna::difference_kind::substitution });
+
+	auto bytes = dna::diff_stream::encode(diffs);
+	REQUIRE(bytes.size() <= diffs.size() * 5 + 1);
+}
+
+TEST_CASE("Alternate bases are taken from the second person", "[diffstream]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	std::vector<dna::base> bases;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		genome_builder builder;
+		builder.body(400, static_cast<unsigned>(i + 1));
+		if (i == 2)
+			bases = builder.bases();
+		data[i] = builder.packed();
+	}
+	dna::Person b(data);
+
+	std::vector<dna::difference> diffs = {
+		{ 2, { 10, 11 }, { 11, 12 }, dna::difference_kind::substitution },
+		{ 2, { 100, 100 }, { 101, 141 }, dna::difference_kind::insertion },
+		{ 2, { 200, 203 }, { 240, 240 }, dna::difference_kind::deletion },
+	};
+
+	temp_file file("alternate");
+	{
+		dna::diff_writer writer(file.path());
+		writer.append(diffs, b);
+	}
+
+	dna::diff_reader reader(file.path());
+	std::size_t index = 0;
+	for (const auto& record : reader)
+	{
+		const auto& diff = diffs[index++];
+		REQUIRE(record.diff == diff);
+		REQUIRE(record.alternate.size() == diff.b.size());
+		for (std::size_t i = 0; i < diff.b.size(); i++)
+			REQUIRE(record.alternate[i] == bases[diff.b.first + i]);
+	}
+	REQUIRE(index == diffs.size());
+}
+
+TEST_CASE("Workers can append to one stream at once", "[diffstream]")
+{
+	temp_file file("workers");
+	std::vector<dna::difference> expected;
+	{
+		dna::diff_writer writer(file.path());
+		std::vector<std::thread> workers;
+		for (std::size_t w = 0; w < 4; w++)
+		{
+			std::vector<dna::difference> batch;
+			for (std::size_t i = 0; i < 500; i++)
+				batch.push_back({ w, { i * 10, i * 10 + 1 }, { i * 10 + w, i * 10 + w + 1 }, dna::difference_kind::substitution });
+			expected.insert(expected.end(), batch.begin(), batch.end());
+
+			workers.emplace_back([&writer, batch] {
+				for (std::size_t i = 0; i < batch.size(); i += 50)
+					writer.append(std::span<const dna::difference>(batch).subspan(i, 50));
+			});
+		}
+		for (auto& worker : workers)
+			worker.join();
+		writer.flush();
+	}
+
+	auto diffs = dna::diff_reader(file.path()).read_all();
+	auto order = [](const dna::difference& x, const dna::difference& y) {
+		return std::tie(x.chromosome, x.a.first) < std::tie(y.chromosome, y.a.first);
+	};
+	std::sort(diffs.begin(), diffs.end(), order);
+	std::sort(expected.begin(), expected.end(), order);
+	REQUIRE(diffs == expected);
+}
+
+TEST_CASE("Malformed streams are rejected", "[diffstream]")
+{
+	temp_file file("malformed");
+	{
+		std::ofstream out(file.path(), std::ios::binary);
+		out << "NOTADIFF00000000";
+	}
+	REQUIRE_THROWS_AS(dna::diff_reader(file.path()), std::runtime_error);
+
+	{
+		dna::diff_writer writer(file.path());
+		writer.append(sample_diffs());
+	}
+	std::filesystem::resize_file(file.path(), std::filesystem::file_size(file.path()) - 2);
+	dna::diff_reader reader(file.path());
+	REQUIRE_THROWS_AS(reader.read_all(), std::runtime_error);
+
+	// a tag with one of the unused kinds 4-7
+	{
+		dna::diff_writer writer(file.path());
+		writer.append(sample_diffs());
+	}
+	{
+		std::fstream stream(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekg(dna::diff_stream::header_size);
+		auto tag = stream.get();
+		stream.seekp(dna::diff_stream::header_size);
+		stream.put(static_cast<char>((tag & ~dna::diff_stream::kind_mask) | 5));
+	}
+	dna::diff_reader damaged(file.path());
+	REQUIRE_THROWS_AS(damaged.read_all(), std::runtime_error);
+}
@@ -9,7 +9,7 @@
 namespace detail
 {
 
-class binary_traits
+class binary_traits : public std::char_traits<std::byte>
 {
 public:
 	static constexpr std::byte to_upper(std::byte c) noexcept {
@@ -0,0 +1,208 @@
+#include "catch.hpp"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "compare.hpp"
+#include "fingerprint.hpp"
+#include "xxhash.hpp"
+#include "genome_builder.hpp"
+#include "temp_file.hpp"
+
+namespace
+{
+
+using packed = dna::sequence_buffer<std::vector<std::byte>>;
+
+std::uint64_t hash_of(const std::string& text)
+{
+	return dna::xxh64(reinterpret_cast<const std::byte*>(text.data()), text.size());
+}
+
+/*
+ * `head_repeats` full repeats after a 2 base partial, so every chromosome
+ * built here has its first real base at phase 2, then the body and a tail
+ * that fills the last byte.
+ */
+genome_builder chromosome(std::size_t head_repeats, std::size_t body, unsigned seed)
+{
+	genome_builder builder;
+	builder.head_telomere(head_repeats, 2).body(body, seed);
+	builder.tail_telomere(20, (4 - (builder.size() + 20 * 6) % 4) % 4);
+	return builder;
+}
+
+dna::block_tree tree_of(genome_builder& builder, std::size_t block_bytes)
+{
+	packed seq(builder.packed());
+	return dna::block_tree::build(seq, dna::trim_telomeres(seq).bounds, block_bytes);
+}
+
+}
+
+TEST_CASE("XXH64 matches the reference implementation", "[fingerprint]")
+{
+	REQUIRE(hash_of("") == 0xEF46DB3751D8E999ull);
+	REQUIRE(hash_of("a") == 0xD24EC4F1A98C6E5Bull);
+	REQUIRE(hash_of("abc") == 0x44BC2CF5AD770999ull);
+	REQUIRE(hash_of("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ull);
+}
+
+TEST_CASE("Block trees find the blocks that differ", "[fingerprint]")
+{
+	auto a = chromosome(40, 20'000, 1);
+	auto b = chromosome(70, 20'000, 1);
+	std::size_t head_a = 40 * 6 + 2;
+	std::size_t head_b = 70 * 6 + 2;
+
+	// same body behind telomeres of different lengths
+	auto ta = tree_of(a, 256);
+	auto tb = tree_of(b, 256);
+	REQUIRE(ta.first_base() == head_a);
+	REQUIRE(ta.phase() == tb.phase());
+	REQUIRE(ta.leaves().size() > 16);
+	REQUIRE(ta.root() == tb.root());
+	REQUIRE(dna::differing_ranges(ta, tb).empty());
+
+	// an SNP at body position 5000 only changes its own block, 1024 bases counted from the byte of base 0
+	b.bases()[head_b + 5000] = b.bases()[head_b + 5000] == dna::A ? dna::C : dna::A;
+	tb = tree_of(b, 256);
+	REQUIRE(ta.root() != tb.root());
+	auto ranges = dna::differing_ranges(ta, tb);
+	REQUIRE(ranges.size() == 1);
+	REQUIRE(ranges[0] == dna::base_range{ 4 * 1024 - 2, 5 * 1024 - 2 });
+}
+
+TEST_CASE("Blocks past the shorter tree differ", "[fingerprint]")
+{
+	auto a = chromosome(40, 20'000, 2);
+	auto b = chromosome(40, 12'000, 2);
+	auto ta = tree_of(a, 256);
+	auto tb = tree_of(b, 256);
+
+	// the bodies share their first 11999 bases; the block holding base 12000 onwards differs
+	auto ranges = dna::differing_ranges(ta, tb);
+	REQUIRE(!ranges.empty());
+	REQUIRE(ranges.front().first == 11 * 1024 - 2);
+	REQUIRE(ranges.back().last >= 20'000);
+
+	// a 3 base partial repeat puts the first real base at another phase
+	genome_builder other;
+	other.head_telomere(40, 3).body(20'000, 2);
+	other.tail_telomere(20, (4 - (other.size() + 20 * 6) % 4) % 4);
+	auto skewed = tree_of(other, 256);
+	REQUIRE(skewed.phase() != ta.phase());
+	REQUIRE_THROWS_AS(dna::differing_ranges(ta, skewed), std::invalid_argument);
+}
+
+TEST_CASE("Bases the block hashes don't reach are compared", "[fingerprint][compare]")
+{
+	auto a = chromosome(40, 20'000, 3);
+	packed seq(a.packed());
+	auto bounds = dna::trim_telomeres(seq).bounds;
+	dna::alignment_anchor anchor{ bounds.first, bounds.first };
+
+	// equal trees over all bases only leave the last block
+	auto full = tree_of(a, 256);
+	auto pieces = dna::detail::changed_pieces(full, full, anchor, bounds.size());
+	REQUIRE(pieces.size() == 1);
+	REQUIRE(pieces[0].last == bounds.size());
+	REQUIRE(pieces[0].first > 0);
+
+	// equal trees over the first 5000 bases say nothing about the rest
+	auto cut = dna::block_tree::build(seq, { bounds.first, bounds.first + 5000 }, 256);
+	pieces = dna::detail::changed_pieces(cut, cut, anchor, bounds.size());
+	REQUIRE(pieces == std::vector<dna::base_range>{ { 0, bounds.size() } });
+}
+
+TEST_CASE("Block hashes can be stored next to the sample", "[fingerprint][person]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = chromosome(30 + i, 3000, static_cast<unsigned>(i)).packed();
+
+	temp_file file("fingerprints");
+	const auto& path = file.path();
+	dna::work_stealing_pool pool(2);
+
+	dna::Person hashed(data);
+	REQUIRE_FALSE(hashed.known_fingerprints());
+	hashed.write_fingerprints(path, pool);
+	REQUIRE(hashed.known_fingerprints());
+
+	dna::Person reopened(data);
+	reopened.load_fingerprints(path);
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		REQUIRE(reopened.fingerprints(pool)[i].root() == hashed.fingerprints(pool)[i].root());
+		REQUIRE(reopened.fingerprints(pool)[i].first_base() == hashed.fingerprints(pool)[i].first_base());
+	}
+
+	// hashes written for other data are refused
+	data[5].push_back(std::byte{0});
+	dna::Person other(data);
+	REQUIRE_THROWS_AS(other.load_fingerprints(path), std::runtime_error);
+
+	std::filesystem::remove(path);
+	REQUIRE_THROWS_AS(reopened.load_fingerprints(path), std::system_error);
+
+	// a record that starts or runs past its chromosome is damaged
+	auto sizes = hashed.chromosome_bases();
+	auto encoded = dna::fingerprint_index::encode(hashed.fingerprints(pool), sizes);
+	auto damaged = [&](std::size_t field, std::uint64_t value) {
+		auto copy = encoded;
+		std::vector<std::byte> bytes;
+		dna::fingerprint_index::detail::put_u64(bytes, value);
+		std::copy(bytes.begin(), bytes.end(), copy.begin() + static_cast<long>(dna::fingerprint_index::header_size + field));
+		return copy;
+	};
+	REQUIRE_NOTHROW(dna::fingerprint_index::decode(encoded.data(), encoded.size(), sizes));
+	auto past_first = damaged(8, sizes[0] + 4);
+	REQUIRE_THROWS_AS(dna::fingerprint_index::decode(past_first.data(), past_first.size(), sizes), std::runtime_error);
+	auto past_bytes = damaged(16, sizes[0] / 4);
+	REQUIRE_THROWS_AS(dna::fingerprint_index::decode(past_bytes.data(), past_bytes.size(), sizes), std::runtime_error);
+}
+
+TEST_CASE("Comparisons with block hashes only read differing blocks", "[fingerprint][compare]")
+{
+	std::array<std::vector<std::byte>, 23> a_data;
+	std::array<std::vector<std::byte>, 23> b_data;
+	for (std::size_t i = 0; i < a_data.size(); i++)
+	{
+		auto a = chromosome(50, 40'000, static_cast<unsigned>(i));
+		auto b = chromosome(90, 40'000, static_cast<unsigned>(i));
+		if (i == 3)
+		{
+			std::size_t head = 90 * 6 + 2;
+			b.bases()[head + 7000] = b.bases()[head + 7000] == dna::G ? dna::T : dna::G;
+			b.bases()[head + 31000] = b.bases()[head + 31000] == dna::G ? dna::T : dna::G;
+		}
+		if (i == 9)
+		{
+			// 8 bases inserted at body position 25000; the tail shifts by two bytes
+			std::size_t head = 90 * 6 + 2;
+			b.bases().insert(b.bases().begin() + static_cast<long>(head + 25'000), 8, dna::A);
+		}
+		a_data[i] = a.packed();
+		b_data[i] = b.packed();
+	}
+
+	dna::work_stealing_pool pool(2);
+	dna::Person plain_a(a_data);
+	dna::Person plain_b(b_data);
+	dna::Person hashed_a(a_data);
+	dna::Person hashed_b(b_data);
+	hashed_a.fingerprints(pool, 256);
+	hashed_b.fingerprints(pool, 256);
+	REQUIRE_THROWS_AS(hashed_a.fingerprints(pool), std::invalid_argument);
+
+	auto plain_shards = dna::plan_shards(plain_a, plain_b, "a", "b", 1000, pool);
+	auto hashed_shards = dna::plan_shards(hashed_a, hashed_b, "a", "b", 1000, pool);
+	REQUIRE(hashed_shards.size() * 4 < plain_shards.size());
+
+	auto plain = dna::run_local(plain_shards, plain_a, plain_b, pool).diffs;
+	auto hashed = dna::run_local(hashed_shards, hashed_a, hashed_b, pool).diffs;
+	REQUIRE(!plain.empty());
+	REQUIRE(hashed == plain);
+}
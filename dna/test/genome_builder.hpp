@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "base.hpp"
+
+/*
+ * Builds chromosome data a base at a time so tests can describe telomeres,
+ * bodies and mutations directly and then pack them into bytes.
+ */
+class genome_builder
+{
+	std::vector<dna::base> bases_;
+public:
+	/*
+	 * `partial` trailing bases of a repeat (as if the sequencer cut into it),
+	 * then `repeats` complete TTAGGG repeats.
+	 */
+	genome_builder& head_telomere(std::size_t repeats, std::size_t partial = 0)
+	{
+		for (std::size_t i = 6 - partial; i < 6; i++)
+			bases_.push_back(dna::telo[i]);
+		for (std::size_t r = 0; r < repeats; r++)
+			bases_.insert(bases_.end(), dna::telo, dna::telo + 6);
+		return *this;
+	}
+
+	/*
+	 * `repeats` complete TTAGGG repeats, then the first `partial` bases of one more.
+	 */
+	genome_builder& tail_telomere(std::size_t repeats, std::size_t partial = 0)
+	{
+		for (std::size_t r = 0; r < repeats; r++)
+			bases_.insert(bases_.end(), dna::telo, dna::telo + 6);
+		bases_.insert(bases_.end(), dna::telo, dna::telo + partial);
+		return *this;
+	}
+
+	/*
+	 * `count` random bases that start and end with C, so they never extend a telomere.
+	 */
+	genome_builder& body(std::size_t count, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		for (std::size_t i = 0; i < count; i++)
+			bases_.push_back(i == 0 || i + 1 == count ? dna::C : static_cast<dna::base>(rng() % 4));
+		return *this;
+	}
+
+	genome_builder& append(const std::vector<dna::base>& bases)
+	{
+		bases_.insert(bases_.end(), bases.begin(), bases.end());
+		return *this;
+	}
+
+	std::vector<dna::base>& bases()
+	{
+		return bases_;
+	}
+
+	std::size_t size() const
+	{
+		return bases_.size();
+	}
+
+	std::vector<std::byte> packed() const
+	{
+		if (bases_.size() % dna::packed_size::value != 0)
+			throw std::logic_error("packed chromosomes must hold a multiple of 4 bases");
+
+		std::vector<std::byte> data(bases_.size() / dna::packed_size::value);
+		for (std::size_t i = 0; i < data.size(); i++)
+			data[i] = dna::pack(bases_[i * 4], bases_[i * 4 + 1], bases_[i * 4 + 2], bases_[i * 4 + 3]);
+		return data;
+	}
+};
+
+inline dna::base substitute(dna::base value)
+{
+	return static_cast<dna::base>((static_cast<int>(value) + 1) % 4);
+}
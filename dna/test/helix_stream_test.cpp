@@ -0,0 +1,146 @@
+#include "catch.hpp"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "person.hpp"
+#include "allocation_counter.hpp"
+#include "temp_file.hpp"
+
+namespace
+{
+
+std::vector<std::byte> patterned(std::size_t size)
+{
+	std::vector<std::byte> data(size);
+	for (std::size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>((i * 151 + 7) & 0xff);
+	return data;
+}
+
+void write_bytes(const std::filesystem::path& path, const std::vector<std::byte>& data)
+{
+	std::ofstream out(path, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+}
+
+TEST_CASE("Can read a memory mapped chromosome", "[stream]")
+{
+	auto data = patterned(1020);
+	temp_file file("mapped");
+	write_bytes(file.path(), data);
+
+	dna::HelixStream hs(file.path(), 128);
+	REQUIRE(hs.size() == 1020);
+
+	std::size_t offset = 0;
+	while (true)
+	{
+		auto seq = hs.read();
+		if (seq.size() == 0)
+			break;
+		for (std::size_t i = 0; i < seq.buffer().size(); i++)
+			REQUIRE(seq.buffer()[i] == data[offset + i]);
+		offset += seq.buffer().size();
+	}
+	REQUIRE(offset == data.size());
+
+	hs.advise(dna::access_pattern::random, 100, 200);
+	hs.seek(1018);
+	REQUIRE(hs.read().size() == 8);
+}
+
+TEST_CASE("Copies of a mapped stream share the mapping", "[stream]")
+{
+	temp_file file("shared");
+	write_bytes(file.path(), patterned(1020));
+
+	dna::HelixStream hs(file.path(), 128);
+	dna::HelixStream copy(hs);
+
+	copy.seek(0);
+	REQUIRE(copy.read().buffer().data() == hs.read().buffer().data());
+}
+
+TEST_CASE("Can build a Person from chromosome files", "[stream]")
+{
+	temp_file file("person");
+	write_bytes(file.path(), patterned(1020));
+
+	std::array<std::filesystem::path, 23> paths;
+	paths.fill(file.path());
+
+	dna::Person person(paths);
+	for (std::size_t i = 0; i < person.chromosomes(); i++)
+		REQUIRE(person.chromosome(i).size() == 1020);
+}
+
+TEST_CASE("Mapping a missing file throws", "[stream]")
+{
+	REQUIRE_THROWS_AS(dna::HelixStream(std::filesystem::path("/nonexistent/cogdna.bin"), 128), std::system_error);
+}
+
+TEST_CASE("Positional reads leave the stream position alone", "[stream]")
+{
+	auto data = patterned(1020);
+	dna::HelixStream hs(data, 128);
+
+	hs.seek(1000);
+	auto seq = hs.read_at(10, 4);
+	REQUIRE(seq.size() == 16);
+	REQUIRE(seq.buffer()[0] == data[10]);
+	REQUIRE(hs.read().size() == 80);
+
+	REQUIRE(hs.read_at(1016, 100).size() == 16);
+	REQUIRE(hs.read_at(2000, 100).size() == 0);
+}
+
+TEST_CASE("Threads can read different regions of one stream", "[stream]")
+{
+	auto data = patterned(1 << 16);
+	const dna::HelixStream hs(data, 128);
+
+	std::array<std::size_t, 4> mismatches{};
+	std::vector<std::thread> threads;
+	for (std::size_t t = 0; t < mismatches.size(); t++)
+	{
+		threads.emplace_back([&, t]() {
+			auto region = data.size() / mismatches.size();
+			for (std::size_t offset = t * region; offset < (t + 1) * region; offset += 64)
+			{
+				auto seq = hs.read_at(offset, 64);
+				for (std::size_t i = 0; i < 64; i++)
+					mismatches[t] += seq.buffer()[i] != data[offset + i];
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	REQUIRE(mismatches == std::array<std::size_t, 4>{});
+}
+
+TEST_CASE("Copying streams and people never copies chromosome data", "[stream]")
+{
+	constexpr std::size_t chromosome_bytes = 1 << 20;
+
+	std::array<dna::HelixStream, 23> streams;
+	for (auto& stream : streams)
+		stream = dna::HelixStream(patterned(chromosome_bytes), 512);
+	dna::Person person(streams);
+
+	allocation_counter counter;
+
+	dna::HelixStream copy(person.chromosome(0));
+	copy = person.chromosome(1);
+	dna::Person person_copy(person);
+	auto by_value = person_copy.chromosome(22);
+	by_value.read();
+
+	REQUIRE(counter.largest() < chromosome_bytes);
+	REQUIRE(counter.bytes() == 0);
+	REQUIRE(by_value.read_at(0, 1).buffer().data() == person.chromosome(22).read_at(0, 1).buffer().data());
+}
@@ -0,0 +1,126 @@
+#include "catch.hpp"
+#include <vector>
+#include "packed_compare.hpp"
+
+namespace
+{
+
+std::vector<std::byte> patterned(std::size_t size)
+{
+	std::vector<std::byte> data(size);
+	for (std::size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>((i * 151 + 7) & 0xff);
+	return data;
+}
+
+void set_base(std::vector<std::byte>& data, std::size_t index, dna::base value)
+{
+	auto shift = 6 - 2 * (index % 4);
+	auto& b = data[index / 4];
+	b = (b & ~(std::byte{0x3} << shift)) | (static_cast<std::byte>(value) << shift);
+}
+
+dna::base other(dna::base value)
+{
+	return static_cast<dna::base>((static_cast<int>(value) + 1) % 4);
+}
+
+}
+
+TEST_CASE("Identical buffers have no mismatches", "[compare]")
+{
+	dna::sequence_buffer<std::vector<std::byte>> a(patterned(1000));
+	dna::sequence_buffer<std::vector<std::byte>> b(patterned(1000));
+
+	REQUIRE(dna::compare_packed(a, b).empty());
+}
+
+TEST_CASE("Mismatches are reported as ranges", "[compare]")
+{
+	auto data = patterned(1000);
+	dna::sequence_buffer<std::vector<std::byte>> a(data);
+
+	// single SNPs, one at a word edge, and a run crossing a byte and a word boundary
+	for (std::size_t i : { 0, 31, 32, 333, 3999 })
+		set_base(data, i, other(a[i]));
+	for (std::size_t i = 126; i < 135; i++)
+		set_base(data, i, other(a[i]));
+
+	dna::sequence_buffer<std::vector<std::byte>> b(data);
+	auto diffs = dna::compare_packed(a, b);
+
+	REQUIRE(diffs == std::vector<dna::base_range>{
+			{ 0, 1 }, { 31, 33 }, { 126, 135 }, { 333, 334 }, { 3999, 4000 } });
+}
+
+TEST_CASE("Bases past the shorter buffer are a mismatch", "[compare]")
+{
+	dna::sequence_buffer<std::vector<std::byte>> a(patterned(100));
+	dna::sequence_buffer<std::vector<std::byte>> b(patterned(100), 301);
+
+	REQUIRE(dna::compare_packed(a, b) == std::vector<dna::base_range>{ { 301, 400 } });
+}
+
+TEST_CASE("Packed comparison agrees with a per-base comparison", "[compare]")
+{
+	auto data = patterned(517);
+	dna::sequence_buffer<std::vector<std::byte>> a(data);
+
+	for (std::size_t i = 0; i < a.size(); i += 1 + (i * 7) % 97)
+		set_base(data, i, other(a[i]));
+	dna::sequence_buffer<std::vector<std::byte>> b(data);
+
+	std::vector<dna::base_range> expected;
+	for (std::size_t i = 0; i < a.size(); i++)
+	{
+		if (a[i] == b[i])
+			continue;
+		if (!expected.empty() && expected.back().last == i)
+			expected.back().last++;
+		else
+			expected.push_back({ i, i + 1 });
+	}
+
+	REQUIRE(dna::compare_packed(a, b) == expected);
+}
+
+TEST_CASE("Can compare sequences shifted by any number of bases", "[compare]")
+{
+	auto data = patterned(300);
+	dna::sequence_buffer<std::vector<std::byte>> a(data);
+
+	// b is a with 5 extra leading bases and a few SNPs
+	std::vector<std::byte> shifted(302);
+	dna::sequence_buffer<std::vector<std::byte>> filler(patterned(2));
+	for (std::size_t i = 0; i < 5; i++)
+		set_base(shifted, i, filler[i]);
+	for (std::size_t i = 0; i < a.size(); i++)
+		set_base(shifted, i + 5, a[i]);
+	for (std::size_t i : { 10, 11, 500, 1000 })
+		set_base(shifted, i + 5, other(a[i]));
+	dna::sequence_buffer<std::vector<std::byte>> b(shifted);
+
+	for (std::size_t ia = 0; ia < 8; ia++)
+	{
+		for (std::size_t ib = 0; ib < 8; ib++)
+		{
+			std::size_t length = 1100;
+			auto diffs = dna::compare_packed(a, ia, b, ib, length);
+
+			std::vector<dna::base_range> expected;
+			for (std::size_t k = 0; k < length; k++)
+			{
+				if (a[ia + k] == b[ib + k])
+					continue;
+				if (!expected.empty() && expected.back().last == k)
+					expected.back().last++;
+				else
+					expected.push_back({ k, k + 1 });
+			}
+			REQUIRE(diffs == expected);
+		}
+	}
+
+	REQUIRE(dna::compare_packed(a, 0, b, 5, 1195) == std::vector<dna::base_range>{
+			{ 10, 12 }, { 500, 501 }, { 1000, 1001 } });
+}
@@ -0,0 +1,145 @@
+#include "catch.hpp"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "person.hpp"
+#include "genome_builder.hpp"
+#include "temp_file.hpp"
+
+namespace
+{
+
+std::array<std::vector<std::byte>, 23> chromosomes()
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		genome_builder builder;
+		builder.head_telomere(20 + i, i % 6).body(1000 + 400 * i, static_cast<unsigned>(i));
+		builder.tail_telomere(15, (4 - (builder.size() + 15 * 6) % 4) % 4);
+		data[i] = builder.packed();
+	}
+	return data;
+}
+
+/*
+ * Overwrites the little endian uint32 at `offset` of a file.
+ */
+void overwrite_u32(const std::filesystem::path& path, std::size_t offset, std::uint32_t value)
+{
+	std::array<char, 4> bytes;
+	for (std::size_t i = 0; i < bytes.size(); ++i)
+		bytes[i] = static_cast<char>(value >> (8 * i));
+	std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+	out.seekp(static_cast<std::streamoff>(offset));
+	out.write(bytes.data(), bytes.size());
+}
+
+}
+
+TEST_CASE("A saved person opens with the same bases and trim bounds", "[person_file]")
+{
+	auto data = chromosomes();
+	dna::work_stealing_pool pool(2);
+	dna::Person person(data);
+	temp_file file("saved");
+	person.save(file.path(), true, pool);
+
+	auto opened = dna::Person::open(file.path());
+	const std::byte* previous = nullptr;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		INFO("chromosome " << i);
+		const auto& chromosome = opened.chromosome(i);
+		REQUIRE(static_cast<std::size_t>(chromosome.size()) == data[i].size());
+
+		auto bytes = chromosome.read_at(0, data[i].size()).buffer();
+		REQUIRE(std::equal(bytes.begin(), bytes.end(), data[i].begin(), data[i].end()));
+
+		// every chromosome starts on its own page of the one mapping
+		REQUIRE(reinterpret_cast<std::uintptr_t>(bytes.data()) % dna::person_file::payload_alignment == 0);
+		REQUIRE(bytes.data() > previous);
+		previous = bytes.data();
+	}
+	REQUIRE(opened.trim_bounds(pool) == person.trim_bounds(pool));
+}
+
+TEST_CASE("Trim bounds are optional in a person file", "[person_file]")
+{
+	auto data = chromosomes();
+	dna::work_stealing_pool pool(2);
+	dna::Person person(data);
+	temp_file file("untrimmed");
+	person.save(file.path(), false, pool);
+
+	dna::mapped_file mapped(file.path());
+	auto layout = dna::person_file::decode(mapped.data(), mapped.size());
+	REQUIRE_FALSE(layout.trims);
+	REQUIRE(layout.sex == dna::sex_chromosome::unknown);
+	REQUIRE(layout.chromosomes[0].offset == dna::person_file::payload_alignment);
+	REQUIRE(layout.chromosomes[22].bases == data[22].size() * 4);
+
+	// computed on demand instead
+	auto opened = dna::Person::open(file.path());
+	REQUIRE(opened.trim_bounds(pool) == person.trim_bounds(pool));
+}
+
+TEST_CASE("Damaged person files are refused", "[person_file]")
+{
+	auto data = chromosomes();
+	dna::Person person(data);
+	temp_file file("damaged");
+	person.save(file.path());
+	auto size = std::filesystem::file_size(file.path());
+
+	SECTION("truncated")
+	{
+		std::filesystem::resize_file(file.path(), size - dna::person_file::payload_alignment);
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::runtime_error);
+	}
+
+	SECTION("wrong magic")
+	{
+		std::fstream out(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+		out.write("DNAXXXX1", 8);
+		out.close();
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::runtime_error);
+	}
+
+	// the record of chromosome 3, and where its trim fields are
+	auto record = dna::person_file::header_size + 3 * dna::person_file::record_size;
+	auto bases = static_cast<std::uint32_t>(data[3].size() * 4);
+
+	SECTION("trim end past the chromosome")
+	{
+		overwrite_u32(file.path(), record + 20, bases + 4);
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::runtime_error);
+	}
+
+	SECTION("trim start after its end")
+	{
+		overwrite_u32(file.path(), record + 16, bases);
+		overwrite_u32(file.path(), record + 20, bases - 8);
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::runtime_error);
+	}
+
+	SECTION("head telomere longer than the chromosome")
+	{
+		overwrite_u32(file.path(), record + 24, bases);
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::runtime_error);
+	}
+
+	SECTION("partial repeat of a whole repeat")
+	{
+		overwrite_u32(file.path(), record + 32, 6);
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::runtime_error);
+	}
+
+	SECTION("missing")
+	{
+		std::filesystem::remove(file.path());
+		REQUIRE_THROWS_AS(dna::Person::open(file.path()), std::system_error);
+	}
+}
@@ -2,6 +2,8 @@
 #include <array>
 #include "sequence_buffer.hpp"
 #include "person.hpp"
+#include "genome_builder.hpp"
+#include "temp_file.hpp"
 
 dna::base telo[6] = { dna::T, dna::T, dna::A, dna::G, dna::G, dna::G };
 
@@ -228,3 +230,94 @@ TEST_CASE()
 		REQUIRE(count == (4 + completeTelo * 6));
 	}
 }
+
+TEST_CASE("Trim bounds cover every chromosome", "[person]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	std::array<dna::chromosome_trim, 23> expected;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		genome_builder builder;
+		builder.head_telomere(10 + i, i % 6);
+		auto head = builder.size();
+		builder.body(1000, static_cast<unsigned>(i));
+		builder.tail_telomere(30 - i, (4 - (builder.size() + (30 - i) * 6) % 4) % 4);
+		data[i] = builder.packed();
+
+		expected[i] = {
+				{ head, head + 1000 },
+				{ head, 10 + i, i % 6 },
+				{ builder.size() - head - 1000, 30 - i, builder.size() - head - 1000 - (30 - i) * 6 } };
+	}
+
+	dna::Person person(data);
+	dna::work_stealing_pool pool(3);
+
+	// one head at a time before the table exists, and from the table after
+	for (std::size_t i = 0; i < data.size(); i++)
+		REQUIRE(person.trim_begin(i) == expected[i].bounds.first);
+
+	const auto& table = person.trim_bounds(pool);
+	for (std::size_t i = 0; i < table.size(); i++)
+	{
+		INFO("chromosome " << i);
+		REQUIRE(table[i] == expected[i]);
+		REQUIRE(person.trim_begin(i) == expected[i].bounds.first);
+	}
+
+	// cached, and shared with copies
+	dna::Person copy(person);
+	REQUIRE(&person.trim_bounds(pool) == &table);
+	REQUIRE(&copy.trim_bounds(pool) == &table);
+}
+
+TEST_CASE("Trim bounds can be loaded from a sidecar index", "[person]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		genome_builder builder;
+		builder.head_telomere(40 + i, 5).body(2000, static_cast<unsigned>(i));
+		builder.tail_telomere(20, (4 - (builder.size() + 20 * 6) % 4) % 4);
+		data[i] = builder.packed();
+	}
+
+	temp_file file("trim_index");
+	const auto& path = file.path();
+	dna::work_stealing_pool pool(2);
+
+	dna::Person indexed(data);
+	indexed.write_trim_index(path, pool);
+
+	dna::Person reopened(data);
+	reopened.load_trim_index(path);
+	REQUIRE(reopened.trim_bounds(pool) == indexed.trim_bounds(pool));
+
+	// an index written for other data is refused
+	data[3].push_back(std::byte{0});
+	dna::Person other(data);
+	REQUIRE_THROWS_AS(other.load_trim_index(path), std::runtime_error);
+
+	std::filesystem::remove(path);
+	REQUIRE_THROWS_AS(reopened.load_trim_index(path), std::system_error);
+}
+
+TEST_CASE("Trim indexes with trims outside their chromosome are refused", "[person]")
+{
+	std::array<dna::chromosome_trim, 2> table{};
+	table[0] = { { 20, 900 }, { 20, 3, 2 }, { 100, 16, 4 } };
+	table[1] = { { 0, 400 }, { 0, 0, 0 }, { 0, 0, 0 } };
+	std::array<std::size_t, 2> sizes = { 1000, 400 };
+
+	auto bytes = dna::trim_index::encode(table, sizes);
+	REQUIRE(dna::trim_index::decode(bytes.data(), bytes.size(), sizes) == table);
+
+	auto damaged = [&](std::size_t offset, std::byte value) {
+		auto copy = bytes;
+		copy[dna::trim_index::header_size + offset] = value;
+		return copy;
+	};
+	// end past the chromosome, start after the end, and a partial of a whole repeat
+	for (auto copy : { damaged(9, std::byte{0x10}), damaged(5, std::byte{0xff}), damaged(20, std::byte{6}) })
+		REQUIRE_THROWS_AS(dna::trim_index::decode(copy.data(), copy.size(), sizes), std::runtime_error);
+}
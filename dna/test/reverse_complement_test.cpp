@@ -0,0 +1,121 @@
+#include "catch.hpp"
+#include <vector>
+#include "allocation_counter.hpp"
+#include "reverse_complement.hpp"
+
+namespace
+{
+
+std::vector<std::byte> patterned(std::size_t size)
+{
+	std::vector<std::byte> data(size);
+	for (std::size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>((i * 151 + 7) & 0xff);
+	return data;
+}
+
+}
+
+TEST_CASE("Complementing a packed byte complements every base", "[revcomp]")
+{
+	REQUIRE(dna::complement_packed(dna::pack(dna::A, dna::C, dna::G, dna::T)) == dna::pack(dna::T, dna::G, dna::C, dna::A));
+	REQUIRE(dna::complement(dna::A) == dna::T);
+	REQUIRE(dna::complement(dna::C) == dna::G);
+	REQUIRE(dna::complement(dna::G) == dna::C);
+	REQUIRE(dna::complement(dna::T) == dna::A);
+}
+
+TEST_CASE("Reverse complement reads the opposite strand", "[revcomp]")
+{
+	std::array<std::byte, 2> data = {
+			dna::pack(dna::G, dna::A, dna::C, dna::T),
+			dna::pack(dna::A, dna::A, dna::G, dna::G),
+	};
+	dna::sequence_buffer buf(data);
+	auto view = dna::reverse_complement(buf);
+
+	std::vector<dna::base> bases(view.begin(), view.end());
+	std::vector<dna::base> expected = {dna::C, dna::C, dna::T, dna::T, dna::A, dna::G, dna::T, dna::C};
+	REQUIRE(bases == expected);
+}
+
+TEST_CASE("A palindromic site is its own reverse complement", "[revcomp]")
+{
+	// GAATTC, the EcoRI site, padded with a pair that is also palindromic
+	std::array<std::byte, 2> data = {
+			dna::pack(dna::G, dna::A, dna::A, dna::T),
+			dna::pack(dna::T, dna::C, dna::G, dna::C),
+	};
+	dna::sequence_buffer buf(data);
+	auto view = dna::reverse_complement(buf);
+
+	// G C at the end reverse complements to G C at the start
+	REQUIRE(view[0] == dna::G);
+	REQUIRE(view[1] == dna::C);
+	for (std::size_t i = 0; i < 6; i++)
+		REQUIRE(view[2 + i] == buf[i]);
+}
+
+TEST_CASE("Reverse complement words agree with single bases", "[revcomp]")
+{
+	auto data = patterned(37);
+	dna::sequence_buffer buf(data);
+	auto view = dna::reverse_complement(buf);
+
+	for (std::size_t index = 0; index < view.size(); index++)
+	{
+		auto word = view.word_at(index);
+		auto count = std::min<std::size_t>(dna::word_bases, view.size() - index);
+		INFO("index " << index);
+		for (std::size_t i = 0; i < dna::word_bases; i++)
+		{
+			auto value = static_cast<dna::base>((word >> (62 - 2 * i)) & 3);
+			if (i < count)
+				REQUIRE(value == view[index + i]);
+			else
+				REQUIRE(value == dna::A);
+		}
+	}
+	REQUIRE(view.word_at(view.size()) == 0);
+}
+
+TEST_CASE("Reverse complement blocks match the histogram of the opposite strand", "[revcomp]")
+{
+	auto data = patterned(1001);
+	dna::sequence_buffer buf(data);
+	auto view = dna::reverse_complement(buf);
+
+	auto forward = dna::histogram(buf);
+	auto reverse = dna::histogram(view);
+	REQUIRE(reverse[0] == forward[3]);
+	REQUIRE(reverse[1] == forward[2]);
+	REQUIRE(reverse[2] == forward[1]);
+	REQUIRE(reverse[3] == forward[0]);
+}
+
+TEST_CASE("Reverse complement of the reverse complement is the original", "[revcomp]")
+{
+	auto data = patterned(64);
+	dna::sequence_buffer buf(data);
+	auto view = dna::reverse_complement(buf);
+
+	for (std::size_t i = 0; i < buf.size(); i++)
+		REQUIRE(view[buf.size() - 1 - i] == dna::complement(buf[i]));
+}
+
+TEST_CASE("Reverse complement does not allocate", "[revcomp]")
+{
+	auto data = patterned(4096);
+	dna::sequence_buffer buf(data);
+
+	allocation_counter counter;
+	auto view = dna::reverse_complement(buf);
+	std::size_t total = 0;
+	for (auto block : view.blocks())
+		total += block.count;
+	for (auto b : view)
+		total += b == dna::complement(dna::complement(b));
+
+	REQUIRE(total == 2 * buf.size());
+	REQUIRE(counter.allocations() == 0);
+}
@@ -44,3 +44,48 @@ TEST_CASE("Can use an iterator", "[seqbuf]")
 	REQUIRE(bases[7] == dna::C);
 
 }
+
+TEST_CASE("Can read 32 bases as a packed word", "[seqbuf]")
+{
+	std::vector<std::byte> data(20);
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<std::byte>((i * 77 + 13) & 0xff);
+
+	dna::sequence_buffer<std::vector<std::byte>> buf(data, 75);
+	for (std::size_t index = 0; index < buf.size(); index++)
+	{
+		auto word = buf.word_at(index);
+		for (std::size_t i = 0; i < dna::word_bases; i++)
+		{
+			auto expected = index + i < buf.size() ? buf[index + i] : dna::A;
+			REQUIRE(static_cast<dna::base>((word >> (62 - 2 * i)) & 0x3) == expected);
+		}
+	}
+}
+
+TEST_CASE("Can walk a Sequence Buffer a block at a time", "[seqbuf]")
+{
+	std::vector<std::byte> data(20);
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<std::byte>((i * 77 + 13) & 0xff);
+
+	dna::sequence_buffer<std::vector<std::byte>> buf(data, 75);
+
+	std::vector<dna::packed_block> blocks;
+	for (auto block : buf.blocks())
+		blocks.push_back(block);
+
+	REQUIRE(blocks.size() == 3);
+	REQUIRE(blocks[0].index == 0);
+	REQUIRE(blocks[0].count == 32);
+	REQUIRE(blocks[0].mask == ~dna::packed_word{0});
+	REQUIRE(blocks[2].index == 64);
+	REQUIRE(blocks[2].count == 11);
+	REQUIRE(blocks[2].mask == dna::word_mask(11));
+	REQUIRE(blocks[1].word == buf.word_at(32));
+
+	std::array<std::size_t, 4> expected{};
+	for (auto b : buf)
+		expected[static_cast<std::size_t>(b)]++;
+	REQUIRE(dna::histogram(buf) == expected);
+}
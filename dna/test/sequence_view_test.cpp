@@ -0,0 +1,137 @@
+#include "catch.hpp"
+#include <span>
+#include <vector>
+#include "allocation_counter.hpp"
+#include "packed_compare.hpp"
+#include "person.hpp"
+#include "sequence_view.hpp"
+
+namespace
+{
+
+std::vector<std::byte> patterned(std::size_t size)
+{
+	std::vector<std::byte> data(size);
+	for (std::size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>((i * 151 + 7) & 0xff);
+	return data;
+}
+
+using byte_span = std::span<const std::byte>;
+
+}
+
+TEST_CASE("A view can start on any base", "[seqview]")
+{
+	auto data = patterned(16);
+	dna::sequence_buffer buf{byte_span(data)};
+
+	for (std::size_t first = 0; first < 8; first++)
+	{
+		dna::sequence_view view(byte_span(data), first, 21);
+		REQUIRE(view.size() == 21);
+		for (std::size_t i = 0; i < view.size(); i++)
+			REQUIRE(view[i] == buf[first + i]);
+	}
+}
+
+TEST_CASE("Views clamp to the end of their storage", "[seqview]")
+{
+	auto data = patterned(4);
+	dna::sequence_view view(byte_span(data), 13, 100);
+	REQUIRE(view.size() == 3);
+	REQUIRE(dna::sequence_view(byte_span(data), 40, 1).empty());
+	REQUIRE(view.subview(2).size() == 1);
+	REQUIRE(view.subview(5).empty());
+}
+
+TEST_CASE("Subviews compose their offsets", "[seqview]")
+{
+	auto data = patterned(64);
+	dna::sequence_buffer buf{byte_span(data)};
+	dna::sequence_view view(buf);
+
+	auto inner = view.subview(5, 200).subview(3, 100);
+	REQUIRE(inner.first_base() == 8);
+	REQUIRE(inner.size() == 100);
+	for (std::size_t i = 0; i < inner.size(); i++)
+		REQUIRE(inner[i] == buf[8 + i]);
+}
+
+TEST_CASE("View words agree with single bases", "[seqview]")
+{
+	auto data = patterned(20);
+	dna::sequence_view view(byte_span(data), 3, 70);
+
+	for (std::size_t index = 0; index < view.size(); index++)
+	{
+		auto word = view.word_at(index);
+		auto count = std::min<std::size_t>(dna::word_bases, view.size() - index);
+		INFO("index " << index);
+		for (std::size_t i = 0; i < dna::word_bases; i++)
+		{
+			auto value = static_cast<dna::base>((word >> (62 - 2 * i)) & 3);
+			REQUIRE(value == (i < count ? view[index + i] : dna::A));
+		}
+	}
+
+	auto counts = dna::histogram(view);
+	std::array<std::size_t, 4> expected{};
+	for (auto b : view)
+		expected[static_cast<std::size_t>(b)]++;
+	REQUIRE(counts == expected);
+}
+
+TEST_CASE("Views compare by content, not by position", "[seqview]")
+{
+	// the same bases, one copy shifted by one base within its bytes
+	auto data = patterned(40);
+	dna::sequence_buffer buf{byte_span(data)};
+	std::vector<std::byte> shifted(41);
+	for (std::size_t i = 0; i < buf.size(); i++)
+	{
+		auto at = i + 1;
+		auto shift = 6 - 2 * (at % 4);
+		shifted[at / 4] |= static_cast<std::byte>(static_cast<unsigned>(buf[i]) << shift);
+	}
+
+	dna::sequence_view a(byte_span(data), 10, 120);
+	dna::sequence_view b(byte_span(shifted), 11, 120);
+	REQUIRE(a == b);
+	REQUIRE(a.subview(7, 50) == b.subview(7, 50));
+	REQUIRE(a.subview(0, 50) != b.subview(1, 50));
+	REQUIRE(a.subview(0, 50) != a.subview(0, 49));
+}
+
+TEST_CASE("Views work with the packed comparison", "[seqview]")
+{
+	auto data = patterned(64);
+	auto changed = data;
+	changed[20] ^= std::byte{0x30};
+
+	dna::sequence_view a(byte_span(data), 6, 200);
+	dna::sequence_view b(byte_span(changed), 6, 200);
+	REQUIRE(dna::find_mismatch(a, 0, b, 0, a.size()) == 20 * 4 + 1 - 6);
+
+	dna::sequence_view c(byte_span(changed), 2, 200);
+	REQUIRE(dna::find_mismatch(a, 0, c, 4, 190) == 20 * 4 + 1 - 6);
+	REQUIRE(dna::find_mismatch(a.subview(1), 0, b.subview(1), 0, 100) == 20 * 4 - 6);
+
+	auto diffs = dna::compare_packed(a, b);
+	REQUIRE(diffs == std::vector<dna::base_range>{{75, 76}});
+}
+
+TEST_CASE("A stream hands out views without copying", "[seqview]")
+{
+	dna::HelixStream stream(patterned(1024), 64);
+	auto whole = stream.read_at(0, 1024);
+
+	allocation_counter counter;
+	auto view = stream.view(1001, 2000);
+	auto inner = view.subview(3, 1000);
+	REQUIRE(inner.size() == 1000);
+	REQUIRE(inner[0] == whole[1004]);
+	REQUIRE(inner[999] == whole[2003]);
+	REQUIRE(stream.view(4000, 500).size() == 96);
+	REQUIRE(counter.allocations() == 0);
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+#include <array>
+#include <vector>
+#include "compare.hpp"
+#include "person.hpp"
+#include "sex.hpp"
+#include "genome_builder.hpp"
+
+namespace
+{
+
+using packed = dna::sequence_buffer<std::vector<std::byte>>;
+
+packed random_chromosome(std::size_t bases, unsigned seed)
+{
+	genome_builder builder;
+	builder.body(bases, seed);
+	return packed(builder.packed());
+}
+
+/*
+ * Thresholds scaled down so small test chromosomes fall in every zone.
+ */
+dna::sex_classifier small_classifier()
+{
+	dna::sex_classifier classifier;
+	classifier.y_max_bases = 64'000;
+	classifier.y_min_bases = 40'000;
+	classifier.samples = 8;
+	classifier.sample_bases = 512;
+	return classifier;
+}
+
+}
+
+TEST_CASE("Chromosome 23 is classified by its length", "[sex]")
+{
+	auto classifier = small_classifier();
+
+	REQUIRE(dna::classify_sex(random_chromosome(100'000, 1), classifier) == dna::sex_chromosome::x);
+	REQUIRE(dna::classify_sex(random_chromosome(57'000, 2), classifier) == dna::sex_chromosome::y);
+	REQUIRE(dna::classify_sex(packed(std::vector<std::byte>{}), classifier) == dna::sex_chromosome::unknown);
+
+	// too short to tell, and nothing to probe with
+	REQUIRE(dna::classify_sex(random_chromosome(20'000, 3), classifier) == dna::sex_chromosome::unknown);
+}
+
+TEST_CASE("Short chromosomes are probed for Y k-mers", "[sex]")
+{
+	auto classifier = small_classifier();
+	auto y = random_chromosome(20'000, 4);
+	auto x = random_chromosome(20'000, 5);
+
+	// every 16th 32-mer of the "Y" is a probe
+	for (std::size_t i = 0; i + 32 <= y.size(); i += 16)
+		classifier.y_probes.push_back(dna::kmer_at(y, i, 32));
+
+	REQUIRE(dna::count_probe_hits(y, classifier) > 100);
+	REQUIRE(dna::count_probe_hits(x, classifier) == 0);
+	REQUIRE(dna::classify_sex(y, classifier) == dna::sex_chromosome::y);
+	REQUIRE(dna::classify_sex(x, classifier) == dna::sex_chromosome::x);
+
+	// the length still decides where it can
+	REQUIRE(dna::classify_sex(random_chromosome(50'000, 6), classifier) == dna::sex_chromosome::y);
+}
+
+TEST_CASE("Person::sex is computed once and shared with copies", "[sex][person]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = random_chromosome(1000, static_cast<unsigned>(i)).buffer();
+	data[22] = std::vector<std::byte>(dna::sex_classifier{}.y_max_bases / 4 + 1000, std::byte{0x1b});
+
+	dna::Person person(data);
+	REQUIRE(person.sex() == dna::sex_chromosome::x);
+
+	dna::Person copy(person);
+	REQUIRE(copy.sex() == dna::sex_chromosome::x);
+
+	// too short to tell by length alone
+	data[22] = random_chromosome(100'000, 22).buffer();
+	REQUIRE(dna::Person(data).sex() == dna::sex_chromosome::unknown);
+}
+
+TEST_CASE("Chromosome 23 is compared when the sexes match", "[sex][compare]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		genome_builder builder;
+		builder.head_telomere(50, 2).body(4000, static_cast<unsigned>(i)).tail_telomere(50, 2);
+		data[i] = builder.packed();
+	}
+	auto other = data;
+	other[22][500] ^= std::byte{0x40};
+
+	dna::Person a(data);
+	dna::Person b(other);
+	dna::work_stealing_pool pool(2);
+	REQUIRE(a.sex() == b.sex());
+
+	auto diffs = dna::compare(a, b, pool);
+	REQUIRE(diffs.size() == 1);
+	REQUIRE(diffs[0].chromosome == 22);
+}
+
+TEST_CASE("A truncated Y is found by probes and left out of comparisons", "[sex][compare]")
+{
+	std::array<std::vector<std::byte>, 23> x_data;
+	for (std::size_t i = 0; i < 22; i++)
+	{
+		genome_builder builder;
+		builder.head_telomere(50, 2).body(4000, static_cast<unsigned>(i)).tail_telomere(50, 2);
+		x_data[i] = builder.packed();
+	}
+	auto y_data = x_data;
+	auto y = random_chromosome(20'000, 7);
+	x_data[22] = random_chromosome(100'000, 8).buffer();
+	y_data[22] = y.buffer();
+
+	dna::Person x_person(x_data);
+	dna::Person y_person(y_data);
+	REQUIRE(y_person.sex() == dna::sex_chromosome::unknown);
+
+	auto classifier = small_classifier();
+	for (std::size_t i = 0; i + 32 <= y.size(); i += 16)
+		classifier.y_probes.push_back(dna::kmer_at(y, i, 32));
+	x_person.set_sex_classifier(classifier);
+	y_person.set_sex_classifier(classifier);
+	REQUIRE(x_person.sex() == dna::sex_chromosome::x);
+	REQUIRE(y_person.sex() == dna::sex_chromosome::y);
+
+	dna::work_stealing_pool pool(2);
+	auto shards = dna::plan_shards(x_person, y_person, "x", "y", 1000, pool);
+	REQUIRE(!shards.empty());
+	for (const auto& shard : shards)
+		REQUIRE(shard.chromosome != 22);
+	REQUIRE(dna::compare(x_person, y_person, pool).empty());
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+#include <array>
+#include <vector>
+#include "compare.hpp"
+#include "genome_builder.hpp"
+
+namespace
+{
+
+std::array<std::vector<std::byte>, 23> family(std::size_t head_repeats, std::size_t head_partial, const std::vector<std::size_t>& snps)
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		genome_builder builder;
+		builder.head_telomere(head_repeats, head_partial).body(5000, static_cast<unsigned>(i + 1));
+		auto head = head_repeats * 6 + head_partial;
+		for (auto p : snps)
+			builder.bases()[head + p] = substitute(builder.bases()[head + p]);
+		builder.tail_telomere(40, (4 - builder.size() % 4 + 2) % 4 + 2);
+		data[i] = builder.packed();
+	}
+	return data;
+}
+
+}
+
+TEST_CASE("Comparison shards survive serialization", "[shard]")
+{
+	dna::ComparisonShard shard{ "person-17", "person-42", 21, { 602, 4000602 }, { 485, 4000485 }, { 602, 485 } };
+
+	auto line = dna::serialize(shard);
+	REQUIRE(dna::parse_shard(line) == shard);
+	REQUIRE_THROWS_AS(dna::parse_shard("person-17\tperson-42\t21"), std::invalid_argument);
+
+	dna::partial_diffs partial{ {
+			{ 3, { 10, 12 }, { 20, 22 }, dna::difference_kind::substitution },
+			{ 3, { 900, 1000 }, { 910, 910 }, dna::difference_kind::unmatched } } };
+	REQUIRE(dna::parse_partial(dna::serialize(partial)).diffs == partial.diffs);
+	REQUIRE_THROWS_AS(dna::parse_partial("3\t10\t12\t20\t22\t4\n"), std::runtime_error);
+	REQUIRE_THROWS_AS(dna::parse_partial("3\t10\t12\t20\t22\t-1\n"), std::runtime_error);
+}
+
+TEST_CASE("Reduce joins runs cut by shard borders", "[shard]")
+{
+	using dna::difference_kind;
+	dna::partial_diffs left{ { { 0, { 90, 100 }, { 80, 90 }, difference_kind::substitution } } };
+	dna::partial_diffs right{ {
+			{ 0, { 100, 103 }, { 90, 93 }, difference_kind::substitution },
+			{ 0, { 150, 151 }, { 140, 141 }, difference_kind::substitution } } };
+	dna::partial_diffs other{ { { 1, { 5, 6 }, { 5, 6 }, difference_kind::substitution } } };
+
+	std::vector<dna::difference> expected{
+			{ 0, { 90, 103 }, { 80, 93 }, difference_kind::substitution },
+			{ 0, { 150, 151 }, { 140, 141 }, difference_kind::substitution },
+			{ 1, { 5, 6 }, { 5, 6 }, difference_kind::substitution } };
+
+	REQUIRE(dna::reduce(dna::reduce(left, right), other).diffs == expected);
+	REQUIRE(dna::reduce(left, dna::reduce(right, other)).diffs == expected);
+	REQUIRE(dna::reduce(other, dna::reduce(right, left)).diffs == expected);
+	REQUIRE(dna::reduce(left, left).diffs == left.diffs);
+}
+
+TEST_CASE("Small shards give the same result as one shard per chromosome", "[shard]")
+{
+	// a run of SNPs across 1000 is cut by every shard size below
+	dna::Person a(family(100, 2, {}));
+	dna::Person b(family(80, 5, { 3, 998, 999, 1000, 1001, 2500, 4999 }));
+	dna::work_stealing_pool pool(3);
+
+	auto whole = dna::run_local(dna::plan_shards(a, b, "a", "b", 1 << 20), a, b, pool);
+	REQUIRE(whole.diffs.size() == 23 * 4);
+
+	for (std::size_t shard_bases : { 1000, 333, 64, 1 << 8 })
+	{
+		auto shards = dna::plan_shards(a, b, "a", "b", shard_bases);
+		REQUIRE(shards.size() > 23);
+
+		// the distributed path: every shard travels as text and is mapped on its own
+		dna::partial_diffs distributed;
+		for (auto it = shards.rbegin(); it != shards.rend(); ++it)
+		{
+			auto shard = dna::parse_shard(dna::serialize(*it));
+			auto partial = dna::parse_partial(dna::serialize(dna::map(shard, a, b)));
+			distributed = dna::reduce(partial, distributed);
+		}
+
+		REQUIRE(distributed.diffs == whole.diffs);
+		REQUIRE(dna::run_local(shards, a, b, pool).diffs == whole.diffs);
+	}
+
+	REQUIRE(dna::compare(a, b, pool) == whole.diffs);
+}
@@ -0,0 +1,136 @@
+#include "catch.hpp"
+#include <vector>
+#include "packed_compare.hpp"
+#include "synthetic_genome.hpp"
+#include "telomere.hpp"
+
+namespace synthetic = dna::synthetic;
+
+namespace
+{
+
+using packed = dna::sequence_buffer<std::vector<std::byte>>;
+
+packed finished(const synthetic::body& body, const synthetic::telomere_options& options, std::uint64_t seed,
+		synthetic::chromosome_summary* summary = nullptr)
+{
+	return packed(synthetic::add_telomeres(body, options, seed, summary));
+}
+
+}
+
+TEST_CASE("Random bodies are seeded and start and end with C", "[synthetic]")
+{
+	auto a = synthetic::random_body(1001, 7);
+	auto b = synthetic::random_body(1001, 7);
+	auto c = synthetic::random_body(1001, 8);
+
+	REQUIRE(a.size() == 1001);
+	REQUIRE(a.buffer() == b.buffer());
+	REQUIRE(a.buffer() != c.buffer());
+	REQUIRE(a[0] == dna::C);
+	REQUIRE(a[1000] == dna::C);
+}
+
+TEST_CASE("The packed writer keeps bases across byte borders", "[synthetic]")
+{
+	auto source = synthetic::random_body(203, 3);
+	synthetic::packed_writer out;
+	out.put(dna::G);
+	out.put_range(source, 5, 150);
+	out.put_range(source, 150, 203);
+	auto written = out.finish();
+
+	REQUIRE(written.size() == 1 + 198);
+	REQUIRE(written[0] == dna::G);
+	REQUIRE(dna::find_mismatch(written, 1, source, 5, 198) == 198);
+}
+
+TEST_CASE("SNPs keep the length and only substitute", "[synthetic]")
+{
+	auto source = synthetic::random_body(100'000, 1);
+	synthetic::chromosome_summary summary;
+	auto mutated = synthetic::mutate(source, { 0.01, 0, 20 }, 2, &summary);
+
+	REQUIRE(mutated.size() == source.size());
+	REQUIRE(summary.indels == 0);
+	REQUIRE(summary.snps > 800);
+	REQUIRE(summary.snps < 1200);
+
+	std::size_t differing = 0;
+	for (std::size_t i = 0; i < source.size(); ++i)
+		differing += source[i] != mutated[i];
+	REQUIRE(differing == summary.snps);
+}
+
+TEST_CASE("Indels change the length by at most their size", "[synthetic]")
+{
+	auto source = synthetic::random_body(100'000, 1);
+	synthetic::chromosome_summary summary;
+	auto mutated = synthetic::mutate(source, { 0, 0.001, 10 }, 3, &summary);
+
+	REQUIRE(summary.indels > 50);
+	auto shift = static_cast<long>(mutated.size()) - static_cast<long>(source.size());
+	REQUIRE(std::abs(shift) <= static_cast<long>(10 * summary.indels));
+	REQUIRE(mutated[0] == dna::C);
+	REQUIRE(mutated[mutated.size() - 1] == dna::C);
+}
+
+TEST_CASE("Generated telomeres are what telomere_run finds", "[synthetic]")
+{
+	auto body = synthetic::random_body(5'001, 4);
+	synthetic::telomere_options options{ 30, 20, 0.0, 0 };
+
+	for (std::uint64_t seed = 0; seed < 50; ++seed)
+	{
+		synthetic::chromosome_summary summary;
+		auto chromosome = finished(body, options, seed, &summary);
+		REQUIRE(chromosome.size() % 4 == 0);
+		REQUIRE(chromosome.size() == summary.bases);
+
+		auto head = dna::telomere_run_begin(chromosome);
+		auto tail = dna::telomere_run_end(chromosome);
+		REQUIRE(head.repeats == summary.head_repeats);
+		REQUIRE(head.partial == summary.head_partial);
+		REQUIRE(tail.repeats == summary.tail_repeats);
+		REQUIRE(tail.partial == summary.tail_partial);
+		REQUIRE(chromosome.size() == head.length + body.size() + tail.length);
+	}
+}
+
+TEST_CASE("Lost telomeres take body bases with them", "[synthetic]")
+{
+	auto body = synthetic::random_body(5'001, 5);
+	synthetic::telomere_options options{ 30, 0, 1.0, 40 };
+
+	for (std::uint64_t seed = 0; seed < 20; ++seed)
+	{
+		synthetic::chromosome_summary summary;
+		auto chromosome = finished(body, options, seed, &summary);
+		REQUIRE(chromosome.size() % 4 == 0);
+		REQUIRE(summary.head_repeats == 0);
+		REQUIRE(summary.tail_repeats == 0);
+		REQUIRE(summary.lost_head_bases <= 40);
+		REQUIRE(summary.lost_tail_bases <= 43);
+		REQUIRE(chromosome.size() == body.size() - summary.lost_head_bases - summary.lost_tail_bases);
+		REQUIRE(dna::find_mismatch(chromosome, 0, body, summary.lost_head_bases, chromosome.size()) == chromosome.size());
+	}
+}
+
+TEST_CASE("A male has a Y for chromosome 23", "[synthetic]")
+{
+	REQUIRE(synthetic::scaled_bases(22, 1.0, false) == 156'040'895);
+	REQUIRE(synthetic::scaled_bases(22, 1.0, true) == 57'227'415);
+}
+
+TEST_CASE("Chromosome lengths follow the scale", "[synthetic]")
+{
+	REQUIRE(synthetic::scaled_bases(0, 1.0, true) == 248'956'422);
+	REQUIRE(synthetic::scaled_bases(0, 0.001, true) == 248'956);
+}
+
+TEST_CASE("Each person gets their own seeds", "[synthetic]")
+{
+	REQUIRE(synthetic::derive_seed(1, 0, 0, 0) != synthetic::derive_seed(1, 1, 0, 0));
+	REQUIRE(synthetic::derive_seed(1, 0, 0, 0) == synthetic::derive_seed(1, 0, 0, 0));
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+#include <vector>
+#include "telomere.hpp"
+#include "genome_builder.hpp"
+
+namespace
+{
+
+dna::telomere_run begin_of(genome_builder& builder)
+{
+	auto data = builder.packed();
+	return dna::telomere_run_begin(dna::sequence_buffer<std::vector<std::byte>>(data));
+}
+
+dna::telomere_run end_of(genome_builder& builder)
+{
+	auto data = builder.packed();
+	return dna::telomere_run_end(dna::sequence_buffer<std::vector<std::byte>>(data));
+}
+
+/*
+ * Pads the front or back with C so the sequence fills whole bytes.
+ */
+genome_builder& pad_front(genome_builder& builder)
+{
+	std::vector<dna::base> padded((4 - builder.size() % 4) % 4, dna::C);
+	padded.insert(padded.end(), builder.bases().begin(), builder.bases().end());
+	builder.bases() = padded;
+	return builder;
+}
+
+genome_builder& pad_back(genome_builder& builder)
+{
+	while (builder.size() % 4 != 0)
+		builder.bases().push_back(dna::C);
+	return builder;
+}
+
+}
+
+TEST_CASE("Telomere runs are measured exactly from the start", "[telomere]")
+{
+	for (std::size_t partial = 0; partial < 6; partial++)
+	{
+		for (std::size_t repeats : { 1, 5, 6, 11, 16, 100, 341 })
+		{
+			genome_builder builder;
+			builder.head_telomere(repeats, partial).body(40, 7);
+			auto run = begin_of(pad_back(builder));
+
+			REQUIRE(run.partial == partial);
+			REQUIRE(run.repeats == repeats);
+			REQUIRE(run.length == partial + repeats * 6);
+		}
+	}
+}
+
+TEST_CASE("Telomere runs are measured exactly from the end", "[telomere]")
+{
+	for (std::size_t partial = 0; partial < 6; partial++)
+	{
+		for (std::size_t repeats : { 1, 5, 6, 11, 16, 100, 341 })
+		{
+			genome_builder builder;
+			builder.body(40, 7).tail_telomere(repeats, partial);
+			auto run = end_of(pad_front(builder));
+
+			REQUIRE(run.partial == partial);
+			REQUIRE(run.repeats == repeats);
+			REQUIRE(run.length == partial + repeats * 6);
+		}
+	}
+}
+
+TEST_CASE("A broken repeat ends the telomere", "[telomere]")
+{
+	genome_builder head;
+	head.head_telomere(20, 3);
+	head.bases()[3 + 12 * 6 + 4] = dna::C;
+	head.body(100, 3);
+	REQUIRE(begin_of(pad_back(head)) == dna::telomere_run{ 3 + 12 * 6, 12, 3 });
+
+	genome_builder tail;
+	tail.body(100, 3).tail_telomere(20, 1);
+	tail.bases()[tail.size() - 1 - 9 * 6 - 2] = dna::A;
+	REQUIRE(end_of(pad_front(tail)) == dna::telomere_run{ 1 + 9 * 6, 9, 1 });
+}
+
+TEST_CASE("Sequences without telomeres have an empty run", "[telomere]")
+{
+	genome_builder none;
+	none.body(400, 9);
+	REQUIRE(begin_of(none) == dna::telomere_run{ 0, 0, 0 });
+	REQUIRE(end_of(none) == dna::telomere_run{ 0, 0, 0 });
+
+	// a partial repeat alone is not a telomere
+	genome_builder partial;
+	partial.head_telomere(0, 4).body(400, 9);
+	REQUIRE(begin_of(partial) == dna::telomere_run{ 0, 0, 0 });
+
+	std::vector<std::byte> empty;
+	REQUIRE(dna::telomere_run_begin(dna::sequence_buffer<std::vector<std::byte>>(empty)) == dna::telomere_run{ 0, 0, 0 });
+	REQUIRE(dna::telomere_run_end(dna::sequence_buffer<std::vector<std::byte>>(empty)) == dna::telomere_run{ 0, 0, 0 });
+}
+
+TEST_CASE("A sequence of nothing but telomere is all telomere", "[telomere]")
+{
+	genome_builder builder;
+	builder.head_telomere(66, 0);
+	REQUIRE(begin_of(builder) == dna::telomere_run{ 396, 66, 0 });
+	REQUIRE(end_of(builder) == dna::telomere_run{ 396, 66, 0 });
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+
+/*
+ * A path in the temp directory that is removed again when it goes out of
+ * scope, even if an assertion fails first. A random suffix keeps concurrent
+ * test runs from using the same file.
+ */
+class temp_file
+{
+	std::filesystem::path path_;
+public:
+	explicit temp_file(const std::string& name)
+	{
+		std::random_device random;
+		auto suffix = (std::uint64_t{ random() } << 32) | random();
+		path_ = std::filesystem::temp_directory_path() / ("cogdna_" + name + "_" + std::to_string(suffix));
+	}
+
+	temp_file(const temp_file&) = delete;
+	temp_file& operator=(const temp_file&) = delete;
+
+	~temp_file()
+	{
+		std::error_code ignored;
+		std::filesystem::remove(path_, ignored);
+	}
+
+	const std::filesystem::path& path() const
+	{
+		return path_;
+	}
+};
@@ -0,0 +1,88 @@
+#include "catch.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "work_stealing_pool.hpp"
+#include "person.hpp"
+
+TEST_CASE("Submitted tasks return their results", "[pool]")
+{
+	dna::work_stealing_pool pool(3);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 100; i++)
+		results.push_back(pool.submit([i]() { return i * i; }));
+
+	int sum = 0;
+	for (auto& result : results)
+		sum += pool.wait(result);
+
+	REQUIRE(sum == 328350);
+}
+
+TEST_CASE("Nested parallel work does not deadlock", "[pool]")
+{
+	dna::work_stealing_pool pool(2);
+
+	std::atomic<std::size_t> total{0};
+	pool.parallel_for(0, 23, 1, [&](std::size_t, std::size_t) {
+		// every chromosome task splits itself into chunk tasks on the same pool
+		pool.parallel_for(0, 1000, 10, [&](std::size_t begin, std::size_t end) {
+			total += end - begin;
+		});
+	});
+
+	REQUIRE(total == 23000);
+}
+
+TEST_CASE("Idle workers steal queued tasks", "[pool]")
+{
+	dna::work_stealing_pool pool(4);
+
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	auto outer = pool.submit([&]() {
+		// all of these land on one worker's deque; the others have to steal them
+		pool.parallel_for(0, 64, 1, [&](std::size_t, std::size_t) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			std::lock_guard<std::mutex> lock(mutex);
+			threads.insert(std::this_thread::get_id());
+		});
+	});
+	pool.wait(outer);
+
+	REQUIRE(threads.size() > 1);
+}
+
+TEST_CASE("Exceptions reach the caller", "[pool]")
+{
+	dna::work_stealing_pool pool(2);
+
+	REQUIRE_THROWS_AS(pool.parallel_for(0, 10, 1, [](std::size_t begin, std::size_t) {
+		if (begin == 7)
+			throw std::runtime_error("chunk failed");
+	}), std::runtime_error);
+}
+
+TEST_CASE("Every chromosome of a Person is visited in parallel", "[pool]")
+{
+	std::array<std::vector<std::byte>, 23> data;
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i].resize(100 + i * 10);
+	dna::Person person(data);
+
+	dna::work_stealing_pool pool(4);
+	std::array<std::atomic<long>, 23> sizes{};
+	person.for_each_chromosome(pool, [&](std::size_t index, const dna::HelixStream& chromosome) {
+		sizes[index] = chromosome.size();
+	});
+
+	for (std::size_t i = 0; i < sizes.size(); i++)
+		REQUIRE(sizes[i] == static_cast<long>(100 + i * 10));
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "mapped_file.hpp"
+#include "telomere.hpp"
+
+namespace dna
+{
+
+/*
+ * On-disk telomere trim index of one person, written next to the sample so
+ * later jobs load the trim table instead of scanning 46 chromosome ends.
+ *
+ * All integers are little endian.
+ *   header  8 bytes "DNATRIM1", uint32 version, uint32 chromosome count
+ *   then per chromosome, 24 bytes:
+ *     uint32 size in bases, uint32 first real base, uint32 end of real bases,
+ *     uint32 head repeats, uint32 tail repeats,
+ *     uint8 head partial, uint8 tail partial, 2 bytes padding
+ * The partial counts give the phase of the repeat the sequencer cut into at
+ * each end.
+ */
+namespace trim_index
+{
+
+constexpr char magic[8] = { 'D', 'N', 'A', 'T', 'R', 'I', 'M', '1' };
+constexpr std::uint32_t version = 1;
+constexpr std::size_t header_size = 16;
+constexpr std::size_t record_size = 24;
+
+namespace detail
+{
+
+inline void put_u32(std::byte* out, std::uint32_t value)
+{
+	for (std::size_t i = 0; i < 4; ++i)
+		out[i] = static_cast<std::byte>(value >> (8 * i));
+}
+
+inline std::uint32_t get_u32(const std::byte* in)
+{
+	std::uint32_t value = 0;
+	for (std::size_t i = 0; i < 4; ++i)
+		value |= std::to_integer<std::uint32_t>(in[i]) << (8 * i);
+	return value;
+}
+
+/*
+ * A trim read from a file for a chromosome of `size` bases. Throws
+ * std::runtime_error unless the bounds and both telomere runs lie within the
+ * chromosome, so a damaged or stale file can't send reads past its end.
+ */
+inline chromosome_trim stored_trim(std::size_t size, std::size_t first, std::size_t last,
+		std::size_t head_repeats, std::size_t head_partial, std::size_t tail_repeats, std::size_t tail_partial)
+{
+	using dna::detail::telomere_period;
+
+	if (first > last || last > size)
+		throw std::runtime_error("stored trim bounds lie outside the chromosome");
+	if (head_partial >= telomere_period || tail_partial >= telomere_period)
+		throw std::runtime_error("stored telomere partial repeat is too long");
+
+	telomere_run head{ head_repeats == 0 ? 0 : head_partial + head_repeats * telomere_period, head_repeats, head_partial };
+	telomere_run tail{ tail_repeats == 0 ? 0 : tail_partial + tail_repeats * telomere_period, tail_repeats, tail_partial };
+	if (head.length > size || tail.length > size)
+		throw std::runtime_error("stored telomere is longer than the chromosome");
+	return { { first, last }, head, tail };
+}
+
+}
+
+template<std::size_t N>
+std::vector<std::byte> encode(const std::array<chromosome_trim, N>& table, const std::array<std::size_t, N>& sizes)
+{
+	std::vector<std::byte> out(header_size + N * record_size);
+	for (std::size_t i = 0; i < sizeof(magic); ++i)
+		out[i] = static_cast<std::byte>(magic[i]);
+	detail::put_u32(out.data() + 8, version);
+	detail::put_u32(out.data() + 12, static_cast<std::uint32_t>(N));
+
+	for (std::size_t i = 0; i < N; ++i)
+	{
+		auto* record = out.data() + header_size + i * record_size;
+		detail::put_u32(record, static_cast<std::uint32_t>(sizes[i]));
+		detail::put_u32(record + 4, static_cast<std::uint32_t>(table[i].bounds.first));
+		detail::put_u32(record + 8, static_cast<std::uint32_t>(table[i].bounds.last));
+		detail::put_u32(record + 12, static_cast<std::uint32_t>(table[i].head.repeats));
+		detail::put_u32(record + 16, static_cast<std::uint32_t>(table[i].tail.repeats));
+		record[20] = static_cast<std::byte>(table[i].head.partial);
+		record[21] = static_cast<std::byte>(table[i].tail.partial);
+	}
+	return out;
+}
+
+/*
+ * Decodes an index and checks it against the chromosome sizes of the person it
+ * is loaded for, and every trim against its chromosome. Throws
+ * std::runtime_error for anything that doesn't match.
+ */
+template<std::size_t N>
+std::array<chromosome_trim, N> decode(const std::byte* data, std::size_t size, const std::array<std::size_t, N>& sizes)
+{
+	if (size != header_size + N * record_size)
+		throw std::runtime_error("trim index has the wrong size");
+	for (std::size_t i = 0; i < sizeof(magic); ++i)
+	{
+		if (data[i] != static_cast<std::byte>(magic[i]))
+			throw std::runtime_error("not a trim index");
+	}
+	if (detail::get_u32(data + 8) != version || detail::get_u32(data + 12) != N)
+		throw std::runtime_error("unsupported trim index version");
+
+	std::array<chromosome_trim, N> table;
+	for (std::size_t i = 0; i < N; ++i)
+	{
+		const auto* record = data + header_size + i * record_size;
+		if (detail::get_u32(record) != sizes[i])
+			throw std::runtime_error("trim index does not belong to this sample");
+
+		table[i] = detail::stored_trim(sizes[i], detail::get_u32(record + 4), detail::get_u32(record + 8),
+				detail::get_u32(record + 12), std::to_integer<std::size_t>(record[20]),
+				detail::get_u32(record + 16), std::to_integer<std::size_t>(record[21]));
+	}
+	return table;
+}
+
+template<std::size_t N>
+void write(const std::filesystem::path& path, const std::array<chromosome_trim, N>& table, const std::array<std::size_t, N>& sizes)
+{
+	auto bytes = encode(table, sizes);
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!out)
+		throw std::runtime_error("unable to write " + path.string());
+}
+
+template<std::size_t N>
+std::array<chromosome_trim, N> read(const std::filesystem::path& path, const std::array<std::size_t, N>& sizes)
+{
+	mapped_file file(path);
+	return decode(file.data(), file.size(), sizes);
+}
+
+}
+
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dna
+{
+
+/*
+ * Fixed set of worker threads, each with its own task deque. A worker pushes
+ * and pops its own tasks at the back; an idle worker steals half of another
+ * worker's deque from the front, so a few very large tasks (chromosome 1) and
+ * many small ones (its chunks) still keep every core busy until the end.
+ *
+ * Tasks may submit and wait on further tasks: waiting runs other queued tasks
+ * instead of blocking, so nested chromosome -> chunk work cannot deadlock.
+ */
+class work_stealing_pool
+{
+	using task = std::function<void()>;
+
+	struct alignas(64) worker_queue
+	{
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+
+	std::vector<std::unique_ptr<worker_queue>> queues_;
+	std::vector<std::thread> threads_;
+	std::atomic<std::size_t> pending_;
+	std::atomic<std::size_t> next_queue_;
+	std::atomic<bool> stop_;
+	std::mutex sleep_mutex_;
+	std::condition_variable wake_;
+
+	struct worker_identity
+	{
+		const work_stealing_pool* pool;
+		std::size_t index;
+	};
+
+	static worker_identity& current() noexcept
+	{
+		static thread_local worker_identity identity{ nullptr, 0 };
+		return identity;
+	}
+
+	void push(task t);
+	bool pop_local(std::size_t index, task& t);
+	bool steal(std::size_t thief, task& t);
+	void work(std::size_t index);
+public:
+	explicit work_stealing_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+	~work_stealing_pool();
+
+	work_stealing_pool(const work_stealing_pool&) = delete;
+	work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+	std::size_t size() const noexcept
+	{
+		return threads_.size();
+	}
+
+	template<class F>
+	auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+	/*
+	 * Runs one queued task on the calling thread. Returns false when there was nothing to run.
+	 */
+	bool run_one();
+
+	/*
+	 * Waits for a future, running queued tasks in the meantime. A thread
+	 * outside the pool blocks once there is nothing left for it to run; a
+	 * worker keeps looking, since the task it waits for may still need it.
+	 */
+	template<class R>
+	R wait(std::future<R>& future);
+
+	/*
+	 * Calls f(begin, end) for consecutive slices of [first, last) no larger
+	 * than `grain`, in parallel, and returns when all of them are done.
+	 * The first exception thrown by f is rethrown.
+	 */
+	template<class F>
+	void parallel_for(std::size_t first, std::size_t last, std::size_t grain, F&& f);
+
+	/*
+	 * Process wide pool with one worker per hardware thread.
+	 */
+	static work_stealing_pool& shared();
+};
+
+inline work_stealing_pool::work_stealing_pool(std::size_t threads) :
+		pending_(0),
+		next_queue_(0),
+		stop_(false)
+{
+	threads = std::max<std::size_t>(threads, 1);
+	for (std::size_t i = 0; i < threads; ++i)
+		queues_.push_back(std::make_unique<worker_queue>());
+	for (std::size_t i = 0; i < threads; ++i)
+		threads_.emplace_back([this, i]() { work(i); });
+}
+
+inline work_stealing_pool::~work_stealing_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		stop_ = true;
+	}
+	wake_.notify_all();
+
+	for (auto& thread : threads_)
+		thread.join();
+}
+
+inline void work_stealing_pool::push(task t)
+{
+	auto& self = current();
+	auto index = self.pool == this ? self.index : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+	// counted before it can be taken, so pending_ never drops below the tasks queued
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		pending_.fetch_add(1);
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+		queues_[index]->tasks.push_back(std::move(t));
+	}
+	wake_.notify_one();
+}
+
+inline bool work_stealing_pool::pop_local(std::size_t index, task& t)
+{
+	auto& queue = *queues_[index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.empty())
+		return false;
+
+	t = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	pending_.fetch_sub(1);
+	return true;
+}
+
+inline bool work_stealing_pool::steal(std::size_t thief, task& t)
+{
+	for (std::size_t i = 1; i <= queues_.size(); ++i)
+	{
+		auto victim = (thief + i) % queues_.size();
+		if (victim == thief && current().pool == this)
+			continue;
+
+		std::vector<task> loot;
+		{
+			auto& queue = *queues_[victim];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty())
+				continue;
+
+			auto count = (queue.tasks.size() + 1) / 2;
+			for (std::size_t n = 0; n < count; ++n)
+			{
+				loot.push_back(std::move(queue.tasks.front()));
+				queue.tasks.pop_front();
+			}
+		}
+
+		t = std::move(loot.front());
+		pending_.fetch_sub(1);
+
+		// a worker keeps the rest of the loot, an outside thread hands it back
+		auto home = current().pool == this ? thief : victim;
+		if (loot.size() > 1)
+		{
+			auto& queue = *queues_[home];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			for (auto it = loot.begin() + 1; it != loot.end(); ++it)
+				queue.tasks.push_back(std::move(*it));
+		}
+		return true;
+	}
+	return false;
+}
+
+inline bool work_stealing_pool::run_one()
+{
+	auto& self = current();
+	task t;
+	if (self.pool == this)
+	{
+		if (!pop_local(self.index, t) && !steal(self.index, t))
+			return false;
+	}
+	else if (!steal(next_queue_.load(std::memory_order_relaxed) % queues_.size(), t))
+	{
+		return false;
+	}
+
+	t();
+	return true;
+}
+
+inline void work_stealing_pool::work(std::size_t index)
+{
+	current() = { this, index };
+
+	while (true)
+	{
+		if (run_one())
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		if (stop_ && pending_ == 0)
+			return;
+		wake_.wait(lock, [this]() { return stop_ || pending_ != 0; });
+	}
+}
+
+template<class F>
+auto work_stealing_pool::submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+{
+	using result = std::invoke_result_t<std::decay_t<F>>;
+
+	auto packaged = std::make_shared<std::packaged_task<result()>>(std::forward<F>(f));
+	auto future = packaged->get_future();
+	push([packaged]() { (*packaged)(); });
+	return future;
+}
+
+template<class R>
+R work_stealing_pool::wait(std::future<R>& future)
+{
+	auto worker = current().pool == this;
+	while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		if (run_one())
+			continue;
+		if (!worker)
+			break;
+		std::this_thread::yield();
+	}
+	return future.get();
+}
+
+template<class F>
+void work_stealing_pool::parallel_for(std::size_t first, std::size_t last, std::size_t grain, F&& f)
+{
+	grain = std::max<std::size_t>(grain, 1);
+
+	std::vector<std::future<void>> slices;
+	for (auto begin = first; begin < last; begin += grain)
+	{
+		auto end = std::min(last, begin + grain);
+		slices.push_back(submit([&f, begin, end]() { f(begin, end); }));
+	}
+
+	std::exception_ptr error;
+	for (auto& slice : slices)
+	{
+		try
+		{
+			wait(slice);
+		}
+		catch (...)
+		{
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
+inline work_stealing_pool& work_stealing_pool::shared()
+{
+	static work_stealing_pool pool;
+	return pool;
+}
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace dna
+{
+
+namespace detail
+{
+
+constexpr std::uint64_t xxh_prime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t xxh_prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t xxh_prime3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t xxh_prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t xxh_prime5 = 0x27D4EB2F165667C5ull;
+
+constexpr std::uint64_t rotl64(std::uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t read_le64(const std::byte* p)
+{
+	std::uint64_t value;
+	std::memcpy(&value, p, sizeof(value));
+	if constexpr (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		value = __builtin_bswap64(value);
+	return value;
+}
+
+inline std::uint32_t read_le32(const std::byte* p)
+{
+	std::uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	if constexpr (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		value = __builtin_bswap32(value);
+	return value;
+}
+
+constexpr std::uint64_t xxh_round(std::uint64_t acc, std::uint64_t input)
+{
+	acc += input * xxh_prime2;
+	acc = rotl64(acc, 31);
+	return acc * xxh_prime1;
+}
+
+constexpr std::uint64_t xxh_merge_round(std::uint64_t acc, std::uint64_t value)
+{
+	acc ^= xxh_round(0, value);
+	return acc * xxh_prime1 + xxh_prime4;
+}
+
+}
+
+/*
+ * XXH64 of `length` bytes, as specified by the xxHash project, so hashes
+ * written by one build can be checked by any other implementation.
+ */
+inline std::uint64_t xxh64(const std::byte* data, std::size_t length, std::uint64_t seed = 0)
+{
+	using namespace detail;
+
+	const auto* p = data;
+	const auto* end = data + length;
+	std::uint64_t h;
+
+	if (length >= 32)
+	{
+		std::uint64_t v1 = seed + xxh_prime1 + xxh_prime2;
+		std::uint64_t v2 = seed + xxh_prime2;
+		std::uint64_t v3 = seed;
+		std::uint64_t v4 = seed - xxh_prime1;
+		for (; p + 32 <= end; p += 32)
+		{
+			v1 = xxh_round(v1, read_le64(p));
+			v2 = xxh_round(v2, read_le64(p + 8));
+			v3 = xxh_round(v3, read_le64(p + 16));
+			v4 = xxh_round(v4, read_le64(p + 24));
+		}
+		h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+		h = xxh_merge_round(h, v1);
+		h = xxh_merge_round(h, v2);
+		h = xxh_merge_round(h, v3);
+		h = xxh_merge_round(h, v4);
+	}
+	else
+	{
+		h = seed + xxh_prime5;
+	}
+
+	h += static_cast<std::uint64_t>(length);
+	for (; p + 8 <= end; p += 8)
+	{
+		h ^= xxh_round(0, read_le64(p));
+		h = rotl64(h, 27) * xxh_prime1 + xxh_prime4;
+	}
+	if (p + 4 <= end)
+	{
+		h ^= static_cast<std::uint64_t>(read_le32(p)) * xxh_prime1;
+		h = rotl64(h, 23) * xxh_prime2 + xxh_prime3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+	{
+		h ^= std::to_integer<std::uint64_t>(*p) * xxh_prime5;
+		h = rotl64(h, 11) * xxh_prime1;
+	}
+
+	h ^= h >> 33;
+	h *= xxh_prime2;
+	h ^= h >> 29;
+	h *= xxh_prime3;
+	h ^= h >> 32;
+	return h;
+}
+
+}